@@ -1,19 +1,33 @@
 #include <getopt.h>
 
+#include <algorithm>
 #include <default_params.hpp>
 #include <iostream>
 #include <pibt_mapd.hpp>
+#include <plan_stream.hpp>
 #include <problem.hpp>
 #include <random>
 #include <tp.hpp>
 #include <vector>
 
 void printHelp();
+int run(int argc, char* argv[]);
 std::unique_ptr<MAPD_Solver> getSolver(const std::string solver_name,
                                        MAPD_Instance* P, bool verbose, int argc,
                                        char* argv[], bool use_distance_table);
 
 int main(int argc, char* argv[])
+{
+  // errors of the library are thrown as std::runtime_error
+  try {
+    return run(argc, argv);
+  } catch (const std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return 1;
+  }
+}
+
+int run(int argc, char* argv[])
 {
   std::string instance_file = "";
   std::string output_file = DEFAULT_OUTPUT_FILE;
@@ -30,17 +44,27 @@ int main(int argc, char* argv[])
       {"help", no_argument, 0, 'h'},
       {"time-limit", required_argument, 0, 'T'},
       {"log-short", no_argument, 0, 'L'},
+      {"summary", no_argument, 0, 'S'},
+      {"log-binary", no_argument, 0, 'B'},
+      {"log-stream", no_argument, 0, 'W'},
       {"use-distance-table", no_argument, 0, 'd'},
+      {"dist-cache", required_argument, 0, 'M'},
+      {"no-history", no_argument, 0, 'H'},
       {0, 0, 0, 0},
   };
   bool log_short = false;
+  bool summary_only = false;
+  bool log_binary = false;
+  bool log_stream = false;
+  bool record_history = true;
   int max_comp_time = -1;
   bool use_distance_table = false;
+  int dist_cache_mb = DEFAULT_DIST_CACHE_MB;
 
   // command line args
   int opt, longindex;
   opterr = 0;  // ignore getopt error
-  while ((opt = getopt_long(argc, argv, "i:o:s:vhT:Ld", longopts,
+  while ((opt = getopt_long(argc, argv, "i:o:s:vhT:LdSBWM:H", longopts,
                             &longindex)) != -1) {
     switch (opt) {
       case 'i':
@@ -61,12 +85,27 @@ int main(int argc, char* argv[])
       case 'L':
         log_short = true;
         break;
+      case 'S':
+        summary_only = true;
+        break;
+      case 'B':
+        log_binary = true;
+        break;
+      case 'W':
+        log_stream = true;
+        break;
       case 'T':
         max_comp_time = std::atoi(optarg);
         break;
       case 'd':
         use_distance_table = true;
         break;
+      case 'M':
+        dist_cache_mb = std::max(0, std::atoi(optarg));
+        break;
+      case 'H':
+        record_history = false;
+        break;
       default:
         break;
     }
@@ -88,16 +127,31 @@ int main(int argc, char* argv[])
   // solve
   auto solver =
       getSolver(solver_name, &P, verbose, argc, argv_copy, use_distance_table);
+  solver->setDistanceCacheBudget((std::size_t)dist_cache_mb << 20);
   solver->setLogShort(log_short);
+  solver->setSummaryOnly(summary_only);
+  solver->setRecordHistory(record_history);
+  std::unique_ptr<PlanStream> writer;
+  if (log_binary) {
+    writer = std::make_unique<BinaryPlanWriter>(output_file);
+  } else if (log_stream) {
+    writer = std::make_unique<TextPlanWriter>(output_file);
+  }
+  if (writer) solver->setPlanStream(writer.get());
   solver->solve();
-  if (solver->succeed() && !solver->getSolution().validate(&P)) {
+  if (solver->succeed() && !summary_only &&
+      !solver->getSolution().validate(&P)) {
     std::cout << "error@mapd: invalid results" << std::endl;
     return 0;
   }
   solver->printResult();
 
   // output result
-  solver->makeLog(output_file);
+  if (writer) {
+    solver->closePlanStream();
+  } else {
+    solver->makeLog(output_file);
+  }
   if (verbose) {
     std::cout << "save result as " << output_file << std::endl;
   }
@@ -135,9 +189,15 @@ void printHelp()
       << "  -v --verbose                  print additional info\n"
       << "  -h --help                     help\n"
       << "  -d --use-distance-table       use pre-computed distance table\n"
+      << "  -M --dist-cache [INT]         memory for cached distances (MB), "
+         "0: off\n"
       << "  -s --solver [SOLVER_NAME]     solver, choose from the below\n"
       << "  -T --time-limit [INT]         max computation time (ms)\n"
       << "  -L --log-short                use short log\n"
+      << "  -S --summary                  keep only summary, no validation\n"
+      << "  -B --log-binary               write result in binary format\n"
+      << "  -W --log-stream               write text result while solving\n"
+      << "  -H --no-history               no target history or task events\n"
       << "\nSolver Options:" << std::endl;
   // each solver
   PIBT_MAPD::printHelp();
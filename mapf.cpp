@@ -1,29 +1,45 @@
 #include <getopt.h>
 
 #include <default_params.hpp>
-#include <fstream>
 #include <hca.hpp>
-#include <iomanip>
 #include <iostream>
 #include <pibt.hpp>
 #include <pibt_plus.hpp>
+#include <plan_stream.hpp>
 #include <problem.hpp>
 #include <push_and_swap.hpp>
 #include <random>
-#include <variant>
+#include <sweep.hpp>
 #include <vector>
 
 void printHelp();
+int run(int argc, char* argv[]);
 std::unique_ptr<MAPF_Solver> getSolver(const std::string solver_name,
                                        MAPF_Instance* P, bool verbose, int argc,
                                        char* argv[]);
 
 int main(int argc, char* argv[])
+{
+  // errors of the library are thrown as std::runtime_error
+  try {
+    return run(argc, argv);
+  } catch (const std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return 1;
+  }
+}
+
+int run(int argc, char* argv[])
 {
   std::string instance_file = "";
-  std::string scen_file = "";
-  std::string output_file = DEFAULT_OUTPUT_FILE;
-  std::string solver_name;
+  std::vector<std::string> scen_patterns;
+  std::string sweep_file = "";
+  std::string output_file = "";
+  std::string solver_names = "";
+  std::string agents = "";
+  std::string seeds = "";
+  std::string time_limits = "";
+  int threads = -1;
   bool verbose = false;
   char* argv_copy[argc + 1];
   for (int i = 0; i < argc; ++i) argv_copy[i] = argv[i];
@@ -31,36 +47,48 @@ int main(int argc, char* argv[])
   struct option longopts[] = {
       {"instance", required_argument, 0, 'i'},
       {"scenario", required_argument, 0, 'm'},
+      {"agents", required_argument, 0, 'n'},
       {"output", required_argument, 0, 'o'},
       {"solver", required_argument, 0, 's'},
       {"verbose", no_argument, 0, 'v'},
       {"help", no_argument, 0, 'h'},
       {"time-limit", required_argument, 0, 'T'},
+      {"seed", required_argument, 0, 'r'},
+      {"sweep", required_argument, 0, 'f'},
+      {"threads", required_argument, 0, 'j'},
       {"log-short", no_argument, 0, 'L'},
+      {"summary", no_argument, 0, 'S'},
+      {"log-binary", no_argument, 0, 'B'},
+      {"log-stream", no_argument, 0, 'W'},
       {"make-scen", no_argument, 0, 'P'},
       {0, 0, 0, 0},
   };
   bool make_scen = false;
   bool log_short = false;
-  int max_comp_time = -1;
+  bool summary_only = false;
+  bool log_binary = false;
+  bool log_stream = false;
 
   // command line args
   int opt, longindex;
   opterr = 0;  // ignore getopt error
-  while ((opt = getopt_long(argc, argv, "i:m:o:s:vhPT:L", longopts,
+  while ((opt = getopt_long(argc, argv, "i:m:n:o:s:vhPT:r:f:j:LSBW", longopts,
                             &longindex)) != -1) {
     switch (opt) {
       case 'i':
         instance_file = std::string(optarg);
         break;
       case 'm':
-        scen_file = std::string(optarg);
+        scen_patterns.push_back(std::string(optarg));
+        break;
+      case 'n':
+        agents = std::string(optarg);
         break;
       case 'o':
         output_file = std::string(optarg);
         break;
       case 's':
-        solver_name = std::string(optarg);
+        solver_names = std::string(optarg);
         break;
       case 'v':
         verbose = true;
@@ -74,178 +102,124 @@ int main(int argc, char* argv[])
       case 'L':
         log_short = true;
         break;
+      case 'S':
+        summary_only = true;
+        break;
+      case 'B':
+        log_binary = true;
+        break;
+      case 'W':
+        log_stream = true;
+        break;
       case 'T':
-        max_comp_time = std::atoi(optarg);
+        time_limits = std::string(optarg);
+        break;
+      case 'r':
+        seeds = std::string(optarg);
+        break;
+      case 'f':
+        sweep_file = std::string(optarg);
+        break;
+      case 'j':
+        threads = std::atoi(optarg);
         break;
       default:
         break;
     }
   }
 
-  if (instance_file.length() == 0) {
+  // set up experiments, command line args overwrite the sweep file
+  SweepConfig config;
+  config.agents = SweepConfig::parseIntList(DEFAULT_SWEEP_AGENTS);
+  config.solvers = {"PIBT"};
+  if (sweep_file.length() > 0) config.load(sweep_file);
+  if (instance_file.length() > 0) config.addInstance(instance_file);
+  for (auto& pattern : scen_patterns) config.addScenario(pattern);
+  if (agents.length() > 0) config.agents = SweepConfig::parseIntList(agents);
+  if (solver_names.length() > 0) {
+    config.solvers = SweepConfig::parseList(solver_names);
+  }
+  if (seeds.length() > 0) config.seeds = SweepConfig::parseIntList(seeds);
+  if (time_limits.length() > 0) {
+    config.time_limits = SweepConfig::parseIntList(time_limits);
+  }
+  if (threads != -1) config.threads = threads;
+  config.summary_only = summary_only;
+
+  if (config.maps.empty()) {
     std::cout << "specify instance file using -i [INSTANCE-FILE], e.g.,"
               << std::endl;
-    std::cout << "> ./mapf -i ../instance/sample.txt" << std::endl;
+    std::cout << "> ./mapf -i ../instance/sample.txt -m ../instance/sample.scen"
+              << std::endl;
     return 0;
   }
 
-  if (scen_file.length() == 0) {
-    std::cout << "specify instance file using -m [INSTANCE-FILE], e.g.,"
+  if (config.maps.back().scenarios.empty()) {
+    std::cout << "specify scenario file using -m [SCEN-FILE], e.g.,"
+              << std::endl;
+    std::cout << "> ./mapf -i ../instance/sample.txt -m ../instance/sample.scen"
               << std::endl;
-    std::cout << "> ./mapf -i ../instance/sample.txt" << std::endl;
     return 0;
   }
 
-
-
-  // set up parameters for generating charts
-  std::string base_path = "../instances/mapf/scen-random/random-32-32-20-random-";
-//  std::string base_path = "../instances/mapf/scen-random_1/ost003d-random-";
-//  std::string base_path = "../instances/mapf/scen-random_2/random-64-64-20-random-";
-//  std::string base_path = "../instances/mapf/scen-random_warehouse-10-20-10-2-1/warehouse-10-20-10-2-1-random-";
-//  std::string base_path = "../instances/mapf/scen-random_warehouse-10-20-10-2-2/warehouse-10-20-10-2-2-random-";
-//  std::string base_path = "../instances/mapf/scen-random_warehouse-20-40-10-2-1/warehouse-20-40-10-2-1-random-";
-//  std::string base_path = "../instances/mapf/scen-random_warehouse-20-40-10-2-2/warehouse-20-40-10-2-2-random-";
-
-  using VarType = std::variant<int, float>;
-  std::vector<std::vector<VarType>> obj_table;
-
-
-  // objectives
-  volatile float temp_soc = 0;
-  volatile float temp_soc_lb = 0;
-  volatile float temp_makespan = 0;
-  volatile float temp_makespan_lb = 0;
-  volatile float temp_time = 0;
-
-
-  volatile float sum_soc_over_lb = 0;
-  volatile float sum_makespan_over_lb = 0;
-  volatile float sum_time = 0;
-  volatile float sum_success = 0;
-
-
-  // initialize temporary map for preprocessing flex_table
-  auto t_scen_file = base_path + std::to_string(1) + ".scen";
-  auto t_P = MAPF_Instance(instance_file, t_scen_file, 10);
-  auto t_solver = getSolver(solver_name, &t_P, verbose, argc, argv_copy);
-  t_solver->createFlexTable();
-  auto t_dist_table = t_solver->getDistanceTable();
-  auto t_flex_table = t_solver->getFlexTable();
-
-
-
-
-  int max_num_agents = 200;
-  for (int num_of_agents = 10; num_of_agents <= max_num_agents; num_of_agents = num_of_agents + 10)
-  {
-    // initialize parameters
-    sum_soc_over_lb = 0;
-    sum_makespan_over_lb = 0;
-    sum_time = 0;
-    sum_success = 0;
-
-
-    for (int scen_num = 1; scen_num <= 25; ++scen_num)
-    {
-      scen_file = base_path + std::to_string(scen_num) + ".scen";
-      // set problem
-      auto P = MAPF_Instance(instance_file, scen_file, num_of_agents);
-
-      // set max computation time (otherwise, use param in instance_file)
-      if (max_comp_time != -1) P.setMaxCompTime(max_comp_time);
-
-      // create scenario
-      if (make_scen) {
-        P.makeScenFile(output_file);
-        return 0;
-      }
-
-      // solve
-      auto solver = getSolver(solver_name, &P, verbose, argc, argv_copy);
-      solver->setDistanceTable(t_dist_table);
-      solver->setFlexTable(t_flex_table);
-      solver->setLogShort(log_short);
-      solver->solve();
-      if (solver->succeed() && !solver->getSolution().validate(&P)) {
-        std::cout << "error@mapf: invalid results" << std::endl;
-        return 0;
-      }
-      solver->printResult();
-
-      temp_soc = (float)solver->getSOC();
-      temp_soc_lb = (float)solver->getLowerBoundSOC();
-      temp_makespan = (float)solver->getMakespan();
-      temp_makespan_lb = (float)solver->getLowerBoundMakespan();
-      temp_time = solver->getCompTime();
-
-      if (solver->succeed())
-      {
-        sum_success = sum_success + 1;
-
-        sum_soc_over_lb = sum_soc_over_lb + temp_soc / temp_soc_lb;
-        sum_makespan_over_lb = sum_makespan_over_lb + temp_makespan / temp_makespan_lb;
-        sum_time = sum_time + temp_time;
-      }
-
+  // sweep, run in parallel
+  if (sweep_file.length() > 0 || config.getRunsNum() > 1) {
+    if (output_file.length() > 0) config.output = output_file;
+    Sweep sweep(config, [&](const std::string& solver_name, MAPF_Instance* P) {
+      return getSolver(solver_name, P, verbose, argc, argv_copy);
+    });
+    sweep.run();
+    sweep.printSummary();
+    if (verbose) {
+      std::cout << "save result as " << config.output << std::endl;
     }
-
-    std::vector<VarType> temp_list;
-    temp_list.push_back(num_of_agents);
-    temp_list.push_back(sum_success / 25);
-    temp_list.push_back(sum_time / sum_success);
-    temp_list.push_back(sum_soc_over_lb / sum_success);
-    temp_list.push_back(sum_makespan_over_lb / sum_success);
-
-
-
-    obj_table.push_back(temp_list);
-
-
+    return 0;
   }
 
+  // single run
+  if (output_file.length() == 0) output_file = DEFAULT_OUTPUT_FILE;
+  auto P = MAPF_Instance(config.maps[0].instance, config.maps[0].scenarios[0],
+                         config.agents[0]);
+  if (config.seeds[0] >= 0) P.setSeed(config.seeds[0]);
 
-  // print out the test results
+  // set max computation time (otherwise, use param in instance_file)
+  if (config.time_limits[0] >= 0) P.setMaxCompTime(config.time_limits[0]);
 
-  // Create an output file stream for the CSV file
-  std::ofstream outfile("output.csv");
-
-  // Check if the file is opened successfully
-  if (!outfile.is_open()) {
-    std::cerr << "Failed to open the file." << std::endl;
-    return 1;
+  // create scenario
+  if (make_scen) {
+    P.makeScenFile(output_file);
+    return 0;
   }
 
-  // Set precision for floating point numbers
-  outfile << std::fixed << std::setprecision(5);
-
-  // Iterate over the rows of the table
-  for (const auto& row : obj_table) {
-    // Iterate over the elements in each row
-    for (size_t i = 0; i < row.size(); ++i) {
-      // Use std::visit to handle the different types in VarType
-      std::visit([&outfile](auto&& arg) {
-        outfile << arg;
-      }, row[i]);
-      // Add a comma if it's not the last element in the row
-      if (i < row.size() - 1) {
-        outfile << ",";
-      }
-    }
-    // Print a new line after each row
-    outfile << std::endl;
+  // solve
+  auto solver = getSolver(config.solvers[0], &P, verbose, argc, argv_copy);
+  solver->createFlexTable();
+  solver->setLogShort(log_short);
+  solver->setSummaryOnly(summary_only);
+  std::unique_ptr<PlanStream> writer;
+  if (log_binary) {
+    writer = std::make_unique<BinaryPlanWriter>(output_file);
+  } else if (log_stream) {
+    writer = std::make_unique<TextPlanWriter>(output_file);
   }
+  if (writer) solver->setPlanStream(writer.get());
+  solver->solve();
+  if (solver->succeed() && !summary_only &&
+      !solver->getSolution().validate(&P)) {
+    std::cout << "error@mapf: invalid results" << std::endl;
+    return 0;
+  }
+  solver->printResult();
 
-  // Close the file
-  outfile.close();
-
-
-
-//  // output result
-//  solver->makeLog(output_file);
-//  if (verbose) {
-//    std::cout << "save result as " << output_file << std::endl;
-//  }
+  // output result
+  if (writer) {
+    solver->closePlanStream();
+  } else {
+    solver->makeLog(output_file);
+  }
+  if (verbose) {
+    std::cout << "save result as " << output_file << std::endl;
+  }
 
   return 0;
 }
@@ -280,14 +254,30 @@ void printHelp()
   std::cout << "\nUsage: ./mapf [OPTIONS] [SOLVER-OPTIONS]\n"
             << "\n**instance file is necessary to run MAPF simulator**\n\n"
             << "  -i --instance [FILE_PATH]     instance file path\n"
-            << "  -o --output [FILE_PATH]       ouptut file path\n"
+            << "  -m --scenario [FILE_PATH]     scenario file path, glob\n"
+            << "  -n --agents [LIST]            number of agents, e.g., "
+               "10:200:10\n"
+            << "  -o --output [FILE_PATH]       ouptut file path, "
+               "*.csv or *.json in sweep\n"
             << "  -v --verbose                  print additional info\n"
             << "  -h --help                     help\n"
             << "  -s --solver [SOLVER_NAME]     solver, choose from the below\n"
-            << "  -T --time-limit [INT]         max computation time (ms)\n"
-            << "  -L --log-short                use short log"
+            << "  -T --time-limit [LIST]        max computation time (ms)\n"
+            << "  -r --seed [LIST]              random seed\n"
+            << "  -f --sweep [FILE_PATH]        sweep config file\n"
+            << "  -j --threads [INT]            threads of sweep, default: "
+               "all\n"
+            << "  -L --log-short                use short log\n"
+            << "  -S --summary                  keep only soc/makespan, no "
+               "validation\n"
+            << "  -B --log-binary               write result in binary format, "
+               "single run\n"
+            << "  -W --log-stream               write text result while "
+               "solving, single run\n"
             << "  -P --make-scen                make scenario file using "
-               "random starts/goals"
+               "random starts/goals\n"
+            << "\nLIST is comma-separated, MIN:MAX[:STEP] is a range. "
+               "Multiple values run a sweep\nin parallel, reported per run."
             << "\n\nSolver Options:" << std::endl;
   // each solver
   PIBT::printHelp();
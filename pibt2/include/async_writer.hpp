@@ -0,0 +1,80 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/*
+ * buffered file writer, file I/O is done by a background thread
+ *
+ * The caller fills preallocated buffers; a full buffer is handed to the
+ * writer thread and the caller continues with a free one. The caller waits
+ * only when all buffers are waiting for I/O.
+ */
+class AsyncWriter
+{
+private:
+  static constexpr size_t BUFFER_SIZE = 1 << 20;
+  static constexpr int NUM_BUFFERS = 4;
+
+  std::FILE* fp;
+  std::unique_ptr<char[]> buffers[NUM_BUFFERS];
+  size_t sizes[NUM_BUFFERS];
+
+  // caller side
+  int current;  // buffer being filled
+  char* head;   // next position in current buffer
+  char* tail;   // end of current buffer
+
+  // shared with writer thread
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::deque<int> full;       // buffers to be written, FIFO
+  std::deque<int> available;  // buffers to be filled
+  bool closing;
+  bool failed;
+  std::thread worker;
+
+  void run();     // main of writer thread
+  void submit();  // hand over current buffer and get next one
+
+public:
+  AsyncWriter(const std::string& filename);
+  ~AsyncWriter();
+
+  void write(const char c)
+  {
+    if (head == tail) submit();
+    *head++ = c;
+  }
+  void write(const char* str, size_t len);
+  void write(const std::string& str) { write(str.data(), str.size()); }
+
+  // integer formatting without iostreams
+  void writeInt(int64_t x)
+  {
+    if (tail - head < 24) submit();
+    if (x < 0) {
+      *head++ = '-';
+      x = -x;
+    }
+    char digits[20];
+    int k = 0;
+    do {
+      digits[k++] = '0' + x % 10;
+      x /= 10;
+    } while (x > 0);
+    while (k > 0) *head++ = digits[--k];
+  }
+
+  // flush all and stop writer thread, return false when I/O failed
+  bool close();
+
+  void halt(const std::string& msg) const;
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <atomic>
+#include <limits>
+#include <memory>
+
+#include "util.hpp"
+
+/*
+ * time limit and cancellation, passed from a solver to nested solvers and
+ * searches
+ *
+ * Copies share the cancellation flag, so that a controller keeping a copy
+ * can abort the solver from another thread by cancel(). expired() reads the
+ * clock only once in CHECK_INTERVAL calls and is cheap enough for inner
+ * loops, e.g., each expansion of A*; expiredNow() always reads it.
+ */
+class Deadline
+{
+public:
+  static constexpr int CHECK_INTERVAL = 256;
+
+private:
+  Time::time_point t_end;
+  std::shared_ptr<std::atomic<bool>> cancelled;
+  mutable int countdown;  // calls of expired() until next clock check
+  mutable bool passed;
+
+public:
+  // no time limit
+  Deadline()
+      : t_end(Time::time_point::max()),
+        cancelled(std::make_shared<std::atomic<bool>>(false)),
+        countdown(CHECK_INTERVAL),
+        passed(false)
+  {
+  }
+
+  // ms from now, negative ms gives no time limit
+  explicit Deadline(const int ms) : Deadline()
+  {
+    if (ms >= 0) t_end = after(ms);
+  }
+
+  // nested deadline, at most ms from now, cancelled together with this
+  Deadline within(const int ms) const
+  {
+    Deadline d(*this);
+    if (ms >= 0) d.t_end = std::min(t_end, after(ms));
+    d.countdown = CHECK_INTERVAL;
+    d.passed = false;
+    return d;
+  }
+
+  void cancel() const { cancelled->store(true, std::memory_order_relaxed); }
+  bool isCancelled() const
+  {
+    return cancelled->load(std::memory_order_relaxed);
+  }
+
+  bool expired() const
+  {
+    if (passed || isCancelled()) return passed = true;
+    if (--countdown > 0) return false;
+    countdown = CHECK_INTERVAL;
+    return expiredNow();
+  }
+
+  bool expiredNow() const
+  {
+    if (!passed) passed = isCancelled() || Time::now() >= t_end;
+    return passed;
+  }
+
+  // ms, 0 when expired
+  int getRemainedTime() const
+  {
+    if (expiredNow()) return 0;
+    if (t_end == Time::time_point::max()) {
+      return std::numeric_limits<int>::max();
+    }
+    const auto rest = t_end - Time::now();
+    return std::chrono::duration_cast<std::chrono::milliseconds>(rest).count();
+  }
+
+private:
+  static Time::time_point after(const int ms)
+  {
+    return Time::now() + std::chrono::milliseconds(ms);
+  }
+};
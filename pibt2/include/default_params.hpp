@@ -7,3 +7,5 @@ static constexpr int DEFAULT_MAX_TIMESTEP = 5000;
 static constexpr int DEFAULT_MAX_COMP_TIME = 60000;
 static constexpr float DEFAULT_TASK_FREQUENCY = 1;
 static constexpr int DEFAULT_TASK_NUM = 10;
+static constexpr int DEFAULT_DIST_CACHE_MB = 256;
+static const std::string DEFAULT_SWEEP_AGENTS = "10:200:10";
@@ -0,0 +1,55 @@
+#pragma once
+#include <graph.hpp>
+#include <list>
+
+/*
+ * distance fields computed on demand and kept in LRU order, for MAPD
+ *
+ * A BFS field to a target is computed at the first query to it and kept
+ * while the memory budget allows; the least recently used one is recycled
+ * otherwise. Unlike TargetDistanceTable, any node can be a target, e.g., the
+ * current location of an idle agent, and the memory stays bounded on maps
+ * where V x V does not fit.
+ */
+class DistanceFieldCache
+{
+private:
+  Graph* const G;
+  const int capacity;  // max number of fields
+
+  struct Entry {
+    Node* target;
+    std::vector<int> field;  // node id -> distance to target
+  };
+  using Entries = std::list<Entry>;
+  Entries lru;                              // recently used first
+  std::vector<Entries::iterator> entry_of;  // node id -> entry or end
+  bool isCached(Node* const g) const { return entry_of[g->id] != lru.end(); }
+  const std::vector<int>& getField(Node* const g);
+
+  // counters
+  long long hit_cnt;
+  long long miss_cnt;
+  long long eviction_cnt;
+
+public:
+  // at least one field is kept regardless of the budget
+  DistanceFieldCache(Graph* _G, const std::size_t budget_bytes);
+  // entry_of points into lru of this object
+  DistanceFieldCache(const DistanceFieldCache&) = delete;
+  DistanceFieldCache& operator=(const DistanceFieldCache&) = delete;
+
+  // distance from s to g, getNodesSize() when unreachable
+  int get(Node* const s, Node* const g);
+
+  int getCapacity() const { return capacity; }
+  int getSize() const { return lru.size(); }
+  long long getHitCnt() const { return hit_cnt; }
+  long long getMissCnt() const { return miss_cnt; }
+  long long getEvictionCnt() const { return eviction_cnt; }
+  float getHitRate() const
+  {
+    const long long total = hit_cnt + miss_cnt;
+    return total == 0 ? 0 : (float)hit_cnt / total;
+  }
+};
@@ -0,0 +1,97 @@
+/*
+ * read-only view of a sequence of nodes, e.g., path or configuration
+ */
+
+#pragma once
+#include <cstdint>
+#include <graph.hpp>
+#include <iterator>
+
+/*
+ * The view does not own nodes and must not outlive its source.
+ * Nodes are stored either as pointers or as node ids with a dictionary
+ * (node-id -> node). Only the first 'stored' nodes exist in memory; the
+ * remaining positions up to 'length' refer to the last stored node, i.e.,
+ * the agent stays there.
+ */
+class NodesView
+{
+private:
+  Node* const* data;      // stored nodes
+  const uint32_t* ids;    // or stored node ids
+  const Nodes* dict;      // node-id -> node, used with ids
+  int stored;             // number of stored nodes
+  int length;             // logical length, >= stored
+
+public:
+  NodesView() : data(nullptr), ids(nullptr), dict(nullptr), stored(0), length(0)
+  {
+  }
+  NodesView(const uint32_t* _ids, const Nodes* _dict, int _stored, int _length)
+      : data(nullptr),
+        ids(_ids),
+        dict(_dict),
+        stored(_stored),
+        length(_stored == 0 ? 0 : _length)
+  {
+  }
+  NodesView(const Nodes& nodes)
+      : data(nodes.data()),
+        ids(nullptr),
+        dict(nullptr),
+        stored(nodes.size()),
+        length(nodes.size())
+  {
+  }
+
+  int size() const { return length; }
+  bool empty() const { return length == 0; }
+  Node* operator[](const int k) const
+  {
+    const int j = k < stored ? k : stored - 1;
+    return ids == nullptr ? data[j] : (*dict)[ids[j]];
+  }
+  Node* front() const { return (*this)[0]; }
+  Node* back() const { return (*this)[stored - 1]; }
+
+  // copy, including padding
+  operator Nodes() const
+  {
+    Nodes nodes(length);
+    for (int k = 0; k < length; ++k) nodes[k] = (*this)[k];
+    return nodes;
+  }
+
+  class iterator
+  {
+  private:
+    const NodesView* view;
+    int k;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Node*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Node* const*;
+    using reference = Node*;
+
+    iterator(const NodesView* _view, int _k) : view(_view), k(_k) {}
+    Node* operator*() const { return (*view)[k]; }
+    iterator& operator++()
+    {
+      ++k;
+      return *this;
+    }
+    iterator operator++(int)
+    {
+      iterator tmp = *this;
+      ++k;
+      return tmp;
+    }
+    bool operator==(const iterator& other) const { return k == other.k; }
+    bool operator!=(const iterator& other) const { return k != other.k; }
+  };
+
+  iterator begin() const { return iterator(this, 0); }
+  iterator end() const { return iterator(this, length); }
+};
@@ -0,0 +1,42 @@
+#pragma once
+#include <getopt.h>
+
+/*
+ * re-entrant replacement of getopt_long, used by solvers
+ *
+ * getopt_long keeps its state in globals (optind, optarg, ...), so that
+ * solvers created on several threads cannot parse options at the same time.
+ * The scanner keeps the state by itself and never modifies argv.
+ *
+ * Same conventions as getopt_long:
+ *   short options "-a", clusters "-ab", arguments "-cVALUE" or "-c VALUE"
+ *   long options "--name", "--name=VALUE" or "--name VALUE",
+ *   unique prefixes of long names, "--" ends options
+ * Non-option args are skipped silently, i.e., options of others are ignored.
+ */
+class OptionScanner
+{
+private:
+  const int argc;
+  char* const* argv;
+  const char* optstring;
+  const struct option* const longopts;
+
+  int index;              // current element of argv
+  const char* next_char;  // next short option in current cluster
+  const char* value;      // argument of the last option
+
+  int scanShort();
+  int scanLong();
+
+public:
+  OptionScanner(int _argc, char* const _argv[], const char* _optstring,
+                const struct option* _longopts);
+
+  // option char (or val of longopts), '?' for unknown options or missing
+  // arguments, -1 when all args are scanned
+  int next();
+
+  // argument of the last option, nullptr when it has no argument
+  const char* arg() const { return value; }
+};
@@ -1,5 +1,10 @@
 #pragma once
+#include <functional>
+#include <tuple>
+#include <unordered_map>
+
 #include "problem.hpp"
+#include "trajectories.hpp"
 
 /*
  * array of path
@@ -7,16 +12,38 @@
 
 struct Paths {
 private:
-  std::vector<Path> paths;  // main
+  // main, agent-major, each path is stored without trailing padding;
+  // agents implicitly stay at their last locations until the makespan
+  Trajectories trajectories;
   int makespan;
 
+  // location with padding, t <= makespan
+  Node* at(int i, int t) const { return trajectories.get(t, i); }
+
+  // occupancy index, timestep -> node-id -> agents
+  // built on the first conflict query, then updated by insert/clear
+  mutable bool indexed = false;
+  mutable std::vector<std::unordered_multimap<int, int>> occupancy;
+  void buildIndex() const;
+  void indexPath(int i, int t_from, int t_to) const;
+  void unindexPath(int i, int t_from, int t_to) const;
+
+  // enumerate conflicts (i, j, t), i < j, among agents with mask[i] = true
+  void findConflicts(const std::vector<bool>& mask,
+                     const std::function<void(int, int, int)>& f) const;
+
 public:
-  Paths() {}
+  Paths() : trajectories(Trajectories::AGENT_MAJOR), makespan(0) {}
   Paths(int num_agents);
+  // adopt trajectories, e.g., of plan
+  explicit Paths(const Trajectories& _trajectories);
   ~Paths() {}
 
-  // agent -> path
-  Path get(int i) const;
+  // agent -> path with padding, valid until the paths are modified
+  NodesView get(int i) const;
+
+  // underlying node-id buffer
+  const Trajectories& getTrajectories() const { return trajectories; }
 
   // agent, timestep -> location
   Node* get(int i, int t) const;
@@ -36,7 +63,7 @@ public:
   // clear
   void clear(int i);
 
-  // return paths.size
+  // number of agents
   int size() const;
 
   // joint with other paths
@@ -48,15 +75,15 @@ public:
   // makespan
   int getMakespan() const;
 
-  // cost of paths[i]
+  // cost of path of a_i
   int costOfPath(int i) const;
 
   // sum of cost
   int getSOC() const;
 
   // formatting
-  void format();
-  void shrink();
+  void format();  // materialize padding
+  void shrink();  // cutoff redundant timesteps
 
   // =========================
   // for CBS
@@ -72,6 +99,11 @@ public:
   // count conflict with one path
   int countConflict(int id, const Path& path) const;
 
+  // list conflicts as (agent, agent, timestep)
+  std::vector<std::tuple<int, int, int>> getConflicts() const;
+  std::vector<std::tuple<int, int, int>> getConflicts(
+      const std::vector<int>& sample) const;
+
   // error
   void halt(const std::string& msg) const;
   void warn(const std::string& msg) const;
@@ -46,6 +46,26 @@ private:
   // option
   bool disable_dist_init = false;
 
+  // progress monitor, give up after stall_limit steps without progress
+  // (0: disabled, run until max_timestep)
+  static constexpr int DEFAULT_STALL_LIMIT = 100;
+  int stall_limit = DEFAULT_STALL_LIMIT;
+
+  // livelock detection, heuristic and opt-in
+  // give up when every configuration of the last cycle_limit steps has
+  // already appeared in the recent history (0: disabled). Only locations are
+  // hashed while the next step depends on priorities too, so a revisit is
+  // not necessarily an exact cycle and solvable instances may be given up.
+  static constexpr int HISTORY_SIZE = 64;
+  static constexpr int DEFAULT_CYCLE_LIMIT = 0;
+  int cycle_limit = DEFAULT_CYCLE_LIMIT;
+
+  // Zobrist key of (agent, location), hash of config is XOR of all keys
+  uint64_t getZobristKey(const int i, Node* const v) const;
+
+  // why the main loop stopped, e.g., solved, stall, cycle
+  std::string termination;
+
   // result of priority inheritance: true -> valid, false -> invalid
   bool funcPIBT(Agent* ai, Agent* aj = nullptr);
 
@@ -59,6 +79,10 @@ public:
 
   void updateCURRENTDIS(const Agents& A);
   void setParams(int argc, char* argv[]);
+  void setStallLimit(const int _stall_limit) { stall_limit = _stall_limit; }
+  void setCycleLimit(const int _cycle_limit) { cycle_limit = _cycle_limit; }
+  std::string getTermination() const { return termination; }
+  void makeLogBasicInfo(std::ostream& log);
   static void printHelp();
 
   int evalFlex(Node* a_node, Agent* a);
@@ -1,4 +1,5 @@
 #pragma once
+#include "pickup_field.hpp"
 #include "solver.hpp"
 
 class PIBT_MAPD : public MAPD_Solver
@@ -25,6 +26,9 @@ private:
   Agents occupied_now;
   Agents occupied_next;
 
+  // nearest unassigned task, for free agents
+  PickupField pickups;
+
   // result of priority inheritance: true -> valid, false -> invalid
   bool funcPIBT(Agent* ai, Agent* aj = nullptr);
 
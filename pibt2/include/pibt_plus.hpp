@@ -11,6 +11,10 @@ private:
   // time required to complement plan, default zero
   double comp_time_complement;
 
+  // hand over to Push & Swap after PIBT makes no progress for this many steps
+  static constexpr int DEFAULT_STALL_LIMIT = 20;
+  int stall_limit;
+
 public:
   static const std::string SOLVER_NAME;
 
@@ -20,6 +24,7 @@ public:
   PIBT_PLUS(MAPF_Instance* _P);
   ~PIBT_PLUS() {}
 
-  void makeLog(const std::string& logfile);
+  void makeLogBasicInfo(std::ostream& log);
+  void setParams(int argc, char* argv[]);
   static void printHelp();
 };
@@ -0,0 +1,52 @@
+#pragma once
+#include <unordered_map>
+
+#include "task.hpp"
+
+/*
+ * nearest unassigned task from every node, for free agents in MAPD
+ *
+ * The field keeps, for all nodes, the distance to the nearest pickup location
+ * of registered tasks and its task, so that each query is O(1). Tasks are
+ * ordered by (distance, key, id), i.e., among tasks at the same distance, the
+ * one with the smallest key is taken.
+ *
+ * The field is updated incrementally: add() runs a BFS from the new pickup
+ * location that stops at nodes already having a better task, and remove()
+ * repairs only the nodes whose task was removed, starting from their
+ * neighbors and pickup locations inside. Both cost the number of changed
+ * nodes (times log of it for remove) rather than |V|.
+ */
+class PickupField
+{
+private:
+  Graph* const G;
+
+  struct Entry {
+    Task* task;
+    float key;  // tie-breaker, smaller is preferred
+  };
+  std::unordered_map<Task*, float> keys;    // registered task -> key
+  std::vector<std::vector<Entry>> sources;  // node id -> tasks picked there
+
+  // field, by node id
+  std::vector<int> dist;      // -1: unreachable
+  std::vector<Task*> task;    // nearest task
+  std::vector<float> key_of;  // key of nearest task
+
+  // whether (d, e) precedes the current value of node v
+  bool better(const int d, const Entry& e, const int v) const;
+  void set(const int d, const Entry& e, const int v);
+
+public:
+  PickupField(Graph* _G);
+
+  void add(Task* t, const float key);
+  void remove(Task* t);  // ignored when not registered
+  bool contains(Task* t) const { return keys.count(t) > 0; }
+  bool empty() const { return keys.empty(); }
+
+  // nullptr when no task is reachable
+  Task* getNearest(Node* const v) const;
+  int getDist(Node* const v) const;  // -1 when no task is reachable
+};
@@ -1,19 +1,36 @@
 #pragma once
 #include "problem.hpp"
+#include "trajectories.hpp"
 
 /*
  * array of configurations
+ *
+ * Per-agent timesteps of the last move are maintained incrementally,
+ * so that sum-of-costs and makespan are available even in summary mode,
+ * which keeps only the last configuration.
  */
 
 struct Plan {
 private:
-  Configs configs;  // main
+  Trajectories trajectories;  // main, time-major
+  std::vector<int> last_move;  // agent -> last timestep when moving
+  bool summary_only = false;   // true -> keep only the last configuration
+  int dropped = 0;             // number of configurations not stored
+
+  // update last_move with new configuration
+  void updateLastMove(const Config& c);
 
 public:
+  Plan() {}
+  // adopt trajectories, e.g., of paths
+  explicit Plan(const Trajectories& _trajectories);
   ~Plan() {}
 
-  // timestep -> configuration
-  Config get(const int t) const;
+  // underlying node-id buffer
+  const Trajectories& getTrajectories() const { return trajectories; }
+
+  // timestep -> configuration, valid until the plan is modified
+  NodesView get(const int t) const;
 
   // timestep, agent -> location
   Node* get(const int t, const int i) const;
@@ -24,8 +41,8 @@ public:
   // path cost
   int getPathCost(const int i) const;
 
-  // last configuration
-  Config last() const;
+  // last configuration, valid until the plan is modified
+  NodesView last() const;
 
   // last configuration
   Node* last(const int i) const;
@@ -33,13 +50,20 @@ public:
   // become empty
   void clear();
 
+  // discard all configurations except for the last one, from now on
+  void setSummaryOnly(const bool flag);
+  bool isSummaryOnly() const { return summary_only; }
+
+  // whether all configurations are stored
+  bool isComplete() const { return dropped == 0; }
+
   // add new configuration to the last
   void add(const Config& c);
 
-  // whether configs are empty
+  // whether plan is empty
   bool empty() const;
 
-  // configs.size
+  // number of configurations
   int size() const;
 
   // size - 1
@@ -60,8 +84,11 @@ public:
 
   // when updating a single path,
   // the path should be longer than this value to avoid conflicts
-  int getMaxConstraintTime(const int id, Node* s, Node* g, Graph* G) const;
   int getMaxConstraintTime(const int id, MAPF_Instance* P) const;
+  // with the distance from the start to g
+  int getMaxConstraintTime(const int id, Node* g, const int dist) const;
+  // G must not be shared with other threads, use the one with P otherwise
+  int getMaxConstraintTime(const int id, Node* s, Node* g, Graph* G) const;
 
   // error
   void halt(const std::string& msg) const;
@@ -0,0 +1,196 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "async_writer.hpp"
+#include "problem.hpp"
+
+/*
+ * sink of solutions, receives configurations while solving
+ */
+class PlanStream
+{
+public:
+  virtual ~PlanStream() {}
+
+  // metadata, called once before any configuration; goals are empty in MAPD,
+  // with_targets tells whether targetEvent follows
+  virtual void begin(const std::string& map_file, const int width,
+                     const int height, const Config& starts,
+                     const Config& goals, const bool with_targets) = 0;
+
+  // configuration of the next timestep
+  virtual void config(const NodesView& c) = 0;
+
+  // change of target and task of an agent from the previous one (initially,
+  // start and Task::NIL), only in MAPD; called after the configuration of
+  // the same timestep
+  virtual void targetEvent(const TargetEvent& e) = 0;
+
+  // change of a task, only in MAPD; ignored by default
+  virtual void taskEvent(const TaskEvent& e) {}
+
+  // result info and closed tasks (MAPD) as text, called once at last
+  virtual void end(const std::string& info, const std::string& tasks) = 0;
+};
+
+/*
+ * binary result format, little endian
+ *
+ * header:  "PIBT2PLN", version, map_file, width, height, num_agents,
+ *          starts (node ids), number of goals, goals (node ids),
+ *          with_targets
+ * records: CONFIG  num_moved, { agent_gap, zigzag(node_id delta) }
+ *          TARGET  timestep, agent, zigzag(target delta),
+ *                  zigzag(task_id delta)
+ *          TASK    type, task_id, agent, timestep
+ *          END
+ * footer:  info, tasks, offset of END (8 bytes)
+ *
+ * All integers except the last offset are unsigned LEB128 varints, strings
+ * are length-prefixed. Deltas are from the previous record of the same type;
+ * starts (targets) and Task::NIL (tasks) are used for the first records.
+ * agent_gap is the difference of agent ids from the previous entry (first:
+ * the agent id itself), so that only agents changing their values are
+ * written. TARGET and TASK records are events of TargetEvent and TaskEvent;
+ * TARGET records follow the CONFIG of their timestep.
+ */
+namespace PlanFormat
+{
+static const std::string MAGIC = "PIBT2PLN";
+static constexpr uint64_t VERSION = 2;
+enum Record : uint8_t {
+  END = 0,
+  CONFIG = 1,
+  TASK = 3,
+  TARGET = 4,
+};
+};  // namespace PlanFormat
+
+class BinaryPlanWriter : public PlanStream
+{
+private:
+  static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+  std::FILE* fp;
+  uint64_t written;          // bytes already flushed
+  std::vector<uint8_t> buf;  // not flushed
+
+  std::vector<uint32_t> prev_config;
+  std::vector<uint32_t> prev_targets;  // by TargetEvent
+  std::vector<int> prev_tasks;
+
+  void putVarint(uint64_t x);
+  void putSigned(int64_t x);
+  void putString(const std::string& str);
+  bool writeBuffer();  // false when I/O failed, never throws
+  void flush();
+
+public:
+  BinaryPlanWriter(const std::string& filename);
+  ~BinaryPlanWriter();
+
+  void begin(const std::string& map_file, const int width, const int height,
+             const Config& starts, const Config& goals,
+             const bool with_targets);
+  void config(const NodesView& c);
+  void targetEvent(const TargetEvent& e);
+  void taskEvent(const TaskEvent& e);
+  void end(const std::string& info, const std::string& tasks);
+
+  void halt(const std::string& msg) const;
+};
+
+/*
+ * text result format, written by a background thread while solving
+ *
+ * Same keys as makeLog of solvers, but starts/goals and the solution come
+ * first and the result info (and closed tasks of MAPD, after "task=") follows
+ * the solution, since it is known only at the end. Solutions of MAPD are
+ * configurations as MAPF, and changes of targets are lines of
+ * "timestep@agent->(x,y):task_id" after the configuration of the timestep.
+ */
+class TextPlanWriter : public PlanStream
+{
+private:
+  AsyncWriter out;
+  bool mapd;
+  int timestep;
+
+  void writeNode(const Node* v);
+
+public:
+  TextPlanWriter(const std::string& filename);
+  ~TextPlanWriter() {}
+
+  void begin(const std::string& map_file, const int width, const int height,
+             const Config& starts, const Config& goals,
+             const bool with_targets);
+  void config(const NodesView& c);
+  void targetEvent(const TargetEvent& e);
+  void end(const std::string& info, const std::string& tasks);
+};
+
+class BinaryPlanReader
+{
+private:
+  static constexpr size_t BUFFER_SIZE = 1 << 16;
+
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> fp;  // closed when thrown
+  std::vector<uint8_t> buf;
+  size_t pos;     // read position in buf
+  size_t filled;  // valid bytes in buf
+
+  // header
+  std::string map_file;
+  int width;
+  int height;
+  std::vector<uint32_t> starts;
+  std::vector<uint32_t> goals;
+  bool with_targets;
+
+  // footer
+  std::string info;
+  std::string tasks_info;
+
+  // current values
+  std::vector<uint32_t> config;
+  std::vector<uint32_t> targets;
+  std::vector<int> tasks;
+  TargetEvent target_event;  // target is nullptr, see getTargets
+  TaskEvent task_event;
+
+  uint8_t getByte();
+  uint64_t getVarint();
+  int64_t getSigned();
+  std::string getString();
+  void seek(long offset);
+
+public:
+  BinaryPlanReader(const std::string& filename);
+  ~BinaryPlanReader() {}
+
+  // read next record and update config, targets/tasks (and target_event) or
+  // task_event
+  PlanFormat::Record next();
+
+  const std::string& getMapFile() const { return map_file; }
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+  int getNum() const { return starts.size(); }
+  bool isMAPD() const { return goals.empty(); }
+  bool hasTargets() const { return with_targets; }
+  const std::vector<uint32_t>& getStarts() const { return starts; }
+  const std::vector<uint32_t>& getGoals() const { return goals; }
+  const std::string& getInfo() const { return info; }
+  const std::string& getTasksInfo() const { return tasks_info; }
+  const std::vector<uint32_t>& getConfig() const { return config; }
+  const std::vector<uint32_t>& getTargets() const { return targets; }
+  const std::vector<int>& getTasks() const { return tasks; }
+  const TargetEvent& getTargetEvent() const { return target_event; }
+  const TaskEvent& getTaskEvent() const { return task_event; }
+
+  void halt(const std::string& msg) const;
+};
@@ -1,8 +1,12 @@
 #pragma once
 #include <graph.hpp>
+#include <memory>
+#include <mutex>
 #include <random>
+#include <stdexcept>
 
 #include "default_params.hpp"
+#include "nodes_view.hpp"
 #include "task.hpp"
 #include "util.hpp"
 
@@ -10,8 +14,8 @@ using Config = std::vector<Node*>;  // < loc_0[t], loc_1[t], ... >
 using Configs = std::vector<Config>;
 
 // check two configurations are same or not
-[[maybe_unused]] static bool sameConfig(const Config& config_i,
-                                        const Config& config_j)
+[[maybe_unused]] static bool sameConfig(const NodesView& config_i,
+                                        const NodesView& config_j)
 {
   if (config_i.size() != config_j.size()) return false;
   const int size_i = config_i.size();
@@ -21,28 +25,51 @@ using Configs = std::vector<Config>;
   return true;
 }
 
-[[maybe_unused]] static int getPathCost(const Path& path)
+[[maybe_unused]] static int getPathCost(const NodesView& path)
 {
   int cost = path.size() - 1;
-  auto itr = path.end() - 1;
-  while (itr != path.begin() && *itr == *(itr - 1)) {
-    --cost;
-    --itr;
-  }
+  while (cost > 0 && path[cost] == path[cost - 1]) --cost;
   return cost;
 }
 
 class Problem
 {
+public:
+  // start/goal coordinates of one scenario row
+  struct ScenarioRow {
+    int x_s, y_s, x_g, y_g;
+  };
+  using Scenario = std::vector<ScenarioRow>;
+
+  // loaded map, shared by all instances on it and freed with the last one
+  // the graph is not modified after loading, except its internal path cache
+  struct Map {
+    explicit Map(const std::string& map_file) : G(map_file) {}
+    Grid G;
+    std::mutex mtx;  // guards the path cache of G
+  };
+
 protected:
-  std::string instance;  // instance name
-  Graph* G;              // graph
-  std::mt19937* MT;      // seed
-  Config config_s;       // initial configuration
-  Config config_g;       // goal configuration
-  int num_agents;        // number of agents
-  int max_timestep;      // timestep limit
-  int max_comp_time;     // comp_time limit, ms
+  std::string instance;        // instance name
+  Graph* G = nullptr;          // graph
+  std::mt19937* MT = nullptr;  // seed
+  Config config_s;             // initial configuration
+  Config config_g;             // goal configuration
+  int num_agents = 0;          // number of agents
+  int max_timestep = 0;        // timestep limit
+  int max_comp_time = 0;       // comp_time limit, ms
+
+  // owner of G, shared with sub-instances, nullptr when G is given by caller
+  std::shared_ptr<Map> map;
+
+  // owner of MT when created by this instance, not by its parent
+  std::unique_ptr<std::mt19937> MT_owned;
+  void createMT(const int seed);
+
+  // process-wide caches, each file is loaded once while it is in use
+  static std::shared_ptr<Map> loadMap(const std::string& map_file);
+  static std::shared_ptr<const Scenario> loadScenario(
+      const std::string& scen_file);
 
   // utilities
   void halt(const std::string& msg) const;
@@ -68,6 +95,12 @@ public:
   std::string getInstanceFileName() { return instance; };
 
   void setMaxCompTime(const int t) { max_comp_time = t; }
+  void setSeed(const int seed) { MT->seed(seed); }
+
+  // queries filling the path cache of G, serialized by the lock of the map
+  // since instances on the same map may run on different threads
+  int getPathDist(Node* const s, Node* const g) const;
+  Path getCachedPath(Node* const s, Node* const g) const;
 };
 
 class MAPF_Instance : public Problem
@@ -97,12 +130,16 @@ public:
 class MAPD_Instance : public Problem
 {
 private:
-  float task_frequency;
-  int task_num;
+  float task_frequency = 0;
+  int task_num = 0;
 
   int current_timestep;  // current timestep
-  Tasks TASKS_OPEN;
-  Tasks TASKS_CLOSED;
+
+  // task pool, reserved for task_num tasks so that tasks never move;
+  // task id is the index
+  std::vector<Task> TASKS;
+  Tasks TASKS_OPEN;    // in order of appearance
+  Tasks TASKS_CLOSED;  // in order of completion
 
   Nodes LOCS_PICKUP;             // candidates of pickup locations
   Nodes LOCS_DELIVERY;           // candidates of delivery locations
@@ -120,7 +157,11 @@ public:
   int getCurrentTimestep() const { return current_timestep; }
   float getTaskFrequency() const { return task_frequency; }
   float getTaskNum() const { return task_num; }
-  Tasks getOpenTasks() { return TASKS_OPEN; }
-  Tasks getClosedTasks() { return TASKS_CLOSED; }
-  Nodes getEndpoints() { return LOCS_ENDPOINTS; }
+  const Tasks& getOpenTasks() const { return TASKS_OPEN; }
+  const Tasks& getClosedTasks() const { return TASKS_CLOSED; }
+  Task* getTask(const int id) { return &TASKS[id]; }
+  int getCreatedTaskNum() const { return TASKS.size(); }
+  const Nodes& getPickupLocs() const { return LOCS_PICKUP; }
+  const Nodes& getDeliveryLocs() const { return LOCS_DELIVERY; }
+  const Nodes& getEndpoints() const { return LOCS_ENDPOINTS; }
 };
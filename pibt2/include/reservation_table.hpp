@@ -0,0 +1,46 @@
+#pragma once
+#include <vector>
+
+/*
+ * space-time reservations, (timestep, node id) -> agent, for TP
+ *
+ * Rows of timesteps are kept in a ring buffer starting from the current
+ * timestep; rows of past timesteps are recycled by advance(). The ring is
+ * doubled when a reservation goes beyond it, so that memory is bounded by
+ * the planning horizon instead of the length of the run.
+ */
+class ReservationTable
+{
+public:
+  static constexpr int NIL = -1;
+
+private:
+  int nodes_num;
+  int capacity;            // number of rows
+  int t_begin;             // timestep of the oldest row
+  int head;                // row of t_begin
+  std::vector<int> table;  // capacity x nodes_num, NIL: not reserved
+
+  int index(const int t) const
+  {
+    return ((head + t - t_begin) % capacity) * nodes_num;
+  }
+  void grow(const int t);  // until t is within the ring
+
+public:
+  ReservationTable(const int _nodes_num, const int _capacity = 16);
+
+  // NIL when not reserved, including the timesteps before advance()
+  int get(const int t, const int v_id) const
+  {
+    if (t < t_begin || t >= t_begin + capacity) return NIL;
+    return table[index(t) + v_id];
+  }
+  void set(const int t, const int v_id, const int agent);  // t >= t_begin
+
+  // drop timesteps before t
+  void advance(const int t);
+
+  int getCapacity() const { return capacity; }
+  int getBeginTimestep() const { return t_begin; }
+};
@@ -1,15 +1,18 @@
 #pragma once
-#include <getopt.h>
-
 #include <chrono>
 #include <functional>
 #include <memory>
 #include <queue>
 #include <unordered_map>
 
+#include "deadline.hpp"
+#include "distance_field_cache.hpp"
+#include "option_scanner.hpp"
 #include "paths.hpp"
 #include "plan.hpp"
+#include "plan_stream.hpp"
 #include "problem.hpp"
+#include "target_distance_table.hpp"
 #include "util.hpp"
 
 class MinimumSolver
@@ -30,12 +33,36 @@ private:
 protected:
   bool verbose;    // true -> print additional info
   bool log_short;  // true -> cannot visualize the result, default: false
+  bool summary_only;  // true -> keep only the last configuration of solution
+
+  // -------------------------------
+  // streaming solution
+protected:
+  PlanStream* plan_stream;  // receives solution while solving, optional
+  int streamed;             // number of configurations already streamed
+  void appendConfig(const Config& c);  // add to solution and stream it
+  void flushPlanStream();  // stream configurations not streamed yet
+  virtual void beginPlanStream() {}
+
+public:
+  void setPlanStream(PlanStream* _plan_stream) { plan_stream = _plan_stream; }
+  // finish plan_stream with result info, call after solve()
+  virtual void closePlanStream() {}
 
   // -------------------------------
   // utilities for time
+private:
+  Deadline given_deadline;  // by caller, e.g., parent solver or controller
+
+protected:
+  Deadline deadline;  // given_deadline bounded by max_comp_time, from start
+
 public:
+  // solving is also stopped by the given one, e.g., its cancel()
+  void setDeadline(const Deadline& _deadline) { given_deadline = _deadline; }
+  const Deadline& getDeadline() const { return deadline; }
   int getRemainedTime() const;  // get remained time
-  bool overCompTime() const;    // check time limit
+  bool overCompTime() const;    // check time limit and cancellation
 
   // -------------------------------
   // utilities for debug
@@ -49,7 +76,7 @@ protected:
     std::cout << head << " ";
     info(std::forward<Tail>(tail)...);
   }
-  void halt(const std::string& msg) const;  // halt program
+  void halt(const std::string& msg) const;  // throw std::runtime_error
   void warn(const std::string& msg) const;  // just printing msg
 
   // -------------------------------
@@ -58,6 +85,7 @@ public:
   virtual void setParams(int argc, char* argv[]){};
   void setVerbose(bool _verbose) { verbose = _verbose; }
   void setLogShort(bool _log_short) { log_short = _log_short; }
+  void setSummaryOnly(bool _summary_only) { summary_only = _summary_only; }
 
   // -------------------------------
   // print help
@@ -98,7 +126,7 @@ protected:
       CheckAstarFin& checkAstarFin,  // func: check goal
       CheckInvalidAstarNode&
           checkInvalidAstarNode,  // func: check invalid nodes
-      const int time_limit = -1   // time limit
+      const Deadline& deadline = Deadline()  // time limit
   );
   // typical functions
   static CompareAstarNode compareAstarNodeBasic;
@@ -138,12 +166,12 @@ private:
 
   // distance to goal
 protected:
-  using DistanceTable = std::vector<std::vector<int>>;  // [agent][node_id]
-  DistanceTable distance_table;                         // distance table
-  DistanceTable* distance_table_p;  // pointer, used in nested solvers
-  int preprocessing_comp_time;      // computation time
+  using DistanceTable = std::vector<std::vector<int>>;  // [node_id][node_id]
+  // read-only, shared with other solvers, e.g., nested solvers
+  std::shared_ptr<const DistanceTable> distance_table;  // distance table
+  int preprocessing_comp_time;                          // computation time
 
-  DistanceTable flex_table;         // flexibility table
+  std::shared_ptr<const DistanceTable> flex_table;  // flexibility table
 
   // -------------------------------
   // main
@@ -175,9 +203,15 @@ public:
   virtual void makeLog(const std::string& logfile = "./result.txt");
 
 protected:
-  virtual void makeLogBasicInfo(std::ofstream& log);
+  virtual void makeLogBasicInfo(std::ostream& log);
   virtual void makeLogSolution(std::ofstream& log);
 
+  // streaming
+  void beginPlanStream();
+
+public:
+  void closePlanStream();
+
   // -------------------------------
   // params
 protected:
@@ -196,23 +230,21 @@ public:
   // -------------------------------
   // utilities for distance
 public:
-  int pathDist(Node* const s, Node* const g) const { return G->pathDist(s, g); }
+  int pathDist(Node* const s, Node* const g) const
+  {
+    return P->getPathDist(s, g);
+  }
   int pathDist(const int i,
                Node* const s) const;  // get path distance between s -> g_i
   int pathDist(const int i) const;    // get path distance between s_i -> g_i
   void createDistanceTable();         // compute distance table
-  void setDistanceTable(DistanceTable* p)
+  void setDistanceTable(std::shared_ptr<const DistanceTable> table)
   {
-    distance_table_p = p;
-  }  // used in nested solvers
-
-
-  void setDistanceTable(const DistanceTable& new_table) {
-    distance_table = new_table;
+    distance_table = table;
   }
-
-  void setFlexTable(const DistanceTable& new_table) {
-    flex_table = new_table;
+  void setFlexTable(std::shared_ptr<const DistanceTable> table)
+  {
+    flex_table = table;
   }
   // -------------------------------
   // utilities for getting path
@@ -220,14 +252,15 @@ public:
   // use grid-pathfinding
   Path getPath(Node* const s, Node* const g, bool cache = false) const
   {
-    return G->getPath(s, g, cache);
+    if (cache) return P->getCachedPath(s, g);
+    return G->getPath(s, g, false);
   }
   // prioritized planning
   Path getPrioritizedPath(
-      const int id,                // agent id
-      const Paths& paths,          // already reserved paths
-      const int time_limit = -1,   // time limit
-      const int upper_bound = -1,  // upper bound of timesteps
+      const int id,                           // agent id
+      const Paths& paths,                     // already reserved paths
+      const Deadline& deadline = Deadline(),  // time limit
+      const int upper_bound = -1,             // upper bound of timesteps
       const std::vector<std::tuple<Node*, int>>& constraints =
           {},  // additional constraints, space-time
       CompareAstarNode& compare = compareAstarNodeBasic,  // compare two nodes
@@ -253,10 +286,12 @@ public:
   void createFlexTable();
   int evalFlex(Node* a_node, Node* g_node) const;
   int nodeDist(Node* const s, Node* const g) const;
-  const DistanceTable& getDistanceTable() const {
+  std::shared_ptr<const DistanceTable> getDistanceTable() const
+  {
     return distance_table;
   }
-  const DistanceTable& getFlexTable() const {
+  std::shared_ptr<const DistanceTable> getFlexTable() const
+  {
     return flex_table;
   }
 };
@@ -268,11 +303,22 @@ class MAPD_Solver : public MinimumSolver
 protected:
   MAPD_Instance* const P;  // problem instance
 
-  std::vector<Nodes> hist_targets;  // time, agent -> current target
-  std::vector<Tasks> hist_tasks;    // time, agent -> assigned_task
+  // changes of targets and tasks, kept only when no plan_stream is attached
+  bool record_history;                    // false -> neither kept nor streamed
+  std::vector<TargetEvent> hist_targets;  // in order of timesteps
+  Nodes last_targets;                     // agent -> current target
+  std::vector<int> last_tasks;            // agent -> id of assigned task
+  int targets_timestep;                   // timestep of next appendTargets
+
+  // record targets and tasks of the next timestep
+  void appendTargets(const Nodes& targets, const Tasks& tasks);
+  // change of a task at timestep t, sent to plan_stream if attached
+  void appendTaskEvent(const TaskEvent::Type type, const Task* task,
+                       const int agent, const int t);
 
 public:
   void printResult();
+  void setRecordHistory(bool flag) { record_history = flag; }
 
   // -------------------------------
   // log
@@ -280,21 +326,49 @@ public:
   virtual void makeLog(const std::string& logfile = "./result.txt");
 
 protected:
-  virtual void makeLogBasicInfo(std::ofstream& log);
+  virtual void makeLogBasicInfo(std::ostream& log);
   virtual void makeLogSolution(std::ofstream& log);
+  void makeLogTasks(std::ostream& log);
+
+  // streaming
+  void beginPlanStream();
+
+public:
+  void closePlanStream();
 
   // -------------------------------
   // distance
 protected:
   bool use_distance_table;
   int preprocessing_comp_time;                          // computation time
-  using DistanceTable = std::vector<std::vector<int>>;  // [node_id][node_id]
-  DistanceTable distance_table;                         // distance table
+  using DistanceTable = TargetDistanceTable;  // to pickup, delivery, endpoints
+  std::shared_ptr<const DistanceTable> distance_table;  // read-only, shared
+  std::size_t distance_cache_budget;  // bytes, 0: without cache
+  // other distances, created in solve(), updated by const pathDist
+  mutable std::unique_ptr<DistanceFieldCache> distance_cache;
   int pathDist(Node* const s, Node* const g) const;
 
 private:
   void createDistanceTable();
 
+public:
+  void setDistanceTable(std::shared_ptr<const DistanceTable> table)
+  {
+    distance_table = table;
+  }
+  std::shared_ptr<const DistanceTable> getDistanceTable() const
+  {
+    return distance_table;
+  }
+  void setDistanceCacheBudget(const std::size_t bytes)
+  {
+    distance_cache_budget = bytes;
+  }
+  const DistanceFieldCache* getDistanceCache() const
+  {
+    return distance_cache.get();
+  }
+
   // -------------------------------
   // metric
 public:
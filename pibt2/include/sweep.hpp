@@ -0,0 +1,120 @@
+/*
+ * batch of MAPF experiments run on a thread pool
+ *
+ * One run for each combination of
+ *   (instance, scenario) x agents x solver x seed x time limit
+ * Results are written as soon as all runs before them are finished, so that
+ * the output order does not depend on the number of threads.
+ */
+
+#pragma once
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include "solver.hpp"
+
+struct SweepConfig {
+  // instance file and its scenario files, i.e., one map
+  struct Map {
+    std::string instance;
+    std::vector<std::string> scenarios;
+  };
+
+  std::vector<Map> maps;
+  std::vector<int> agents;
+  std::vector<std::string> solvers;
+  std::vector<int> seeds = {-1};        // -1: seed of instance file
+  std::vector<int> time_limits = {-1};  // ms, -1: max_comp_time of instance
+  int threads = 0;                      // 0: all hardware threads
+  std::string output = "./output.csv";  // *.json -> JSON, otherwise CSV
+  bool summary_only = false;
+
+  /*
+   * key=value file, '#' starts a comment
+   *   instance=FILE        start a new map
+   *   scenario=PATTERN     scenario files of the last map, glob
+   *   agents=10:200:10,250 list, MIN:MAX:STEP is a range
+   *   solver=PIBT,HCA      list
+   *   seed=0:4             list
+   *   time_limit=1000      list
+   *   threads=8
+   *   output=result.csv
+   */
+  void load(const std::string& filename);
+
+  void addInstance(const std::string& instance);
+  void addScenario(const std::string& pattern);  // to the last map
+
+  // comma-separated list of INT or MIN:MAX[:STEP]
+  static std::vector<int> parseIntList(const std::string& str);
+  static std::vector<std::string> parseList(const std::string& str);
+
+  int getRunsNum() const;
+
+  static void halt(const std::string& msg);
+};
+
+struct SweepResult {
+  int id;  // position in the sweep
+  std::string instance;
+  std::string scenario;
+  int agents;
+  std::string solver;
+  int seed;
+  int time_limit;
+  bool solved;
+  bool valid;  // false: invalid solution, not checked in summary mode
+  int soc;
+  int soc_lb;
+  int makespan;
+  int makespan_lb;
+  int comp_time;
+  std::string error;  // message of exception, the run is regarded as failed
+};
+
+class Sweep
+{
+public:
+  // called concurrently by worker threads
+  using SolverFactory = std::function<std::unique_ptr<MAPF_Solver>(
+      const std::string& solver_name, MAPF_Instance* P)>;
+
+private:
+  using Table = std::shared_ptr<const std::vector<std::vector<int>>>;
+
+  const SweepConfig config;
+  SolverFactory factory;
+
+  // distance and flexibility tables of each map, shared by all runs
+  std::vector<Table> distance_tables;
+  std::vector<Table> flex_tables;
+
+  // output
+  std::ofstream out;
+  bool json;
+  int next_id;                          // next result to be written
+  std::map<int, SweepResult> finished;  // waiting for preceding results
+  std::vector<SweepResult> results;     // written, in order
+  std::mutex out_mtx;
+
+  void createTables(const int map_id);
+  SweepResult runOne(SweepResult r, const int map_id);
+  void push(SweepResult r);
+  void write(const SweepResult& r);
+
+public:
+  Sweep(const SweepConfig& _config, SolverFactory _factory);
+  ~Sweep();
+
+  void run();
+
+  // success rate, computation time, soc/LB and makespan/LB
+  // for each map, solver and number of agents
+  void printSummary() const;
+
+  const std::vector<SweepResult>& getResults() const { return results; }
+
+  void halt(const std::string& msg) const;
+  void warn(const std::string& msg) const;
+};
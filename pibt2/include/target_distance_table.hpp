@@ -0,0 +1,32 @@
+#pragma once
+#include <graph.hpp>
+
+/*
+ * distances from all nodes to a fixed set of targets, for MAPD
+ *
+ * MAPD solvers ask for distances to pickup, delivery and endpoint locations.
+ * One BFS field per target (|targets| x V) replaces the all-pairs table
+ * (V x V by Floyd-Warshall, O(V^3)). Fields are computed in parallel.
+ */
+class TargetDistanceTable
+{
+private:
+  std::vector<int> row;                  // node id -> row, -1: not a target
+  std::vector<std::vector<int>> fields;  // row, node id -> distance
+
+public:
+  // num_threads <= 0: number of hardware threads
+  TargetDistanceTable(Graph* G, const Nodes& targets, int num_threads = 0);
+
+  bool isTarget(Node* const g) const { return row[g->id] != -1; }
+  int getTargetsNum() const { return fields.size(); }
+
+  // distance from s to a target g, getNodesSize() when unreachable
+  int get(Node* const s, Node* const g) const
+  {
+    return fields[row[g->id]][s->id];
+  }
+
+  // BFS from g, field has the size of getNodesSize()
+  static void computeField(Graph* G, Node* const g, std::vector<int>& field);
+};
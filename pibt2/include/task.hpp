@@ -1,8 +1,6 @@
 #pragma once
 #include <graph.hpp>
 
-static int TASK_ID_CNT = 0;
-
 struct Task {
   int id;
   Node* loc_pickup;
@@ -14,8 +12,8 @@ struct Task {
 
   static constexpr int NIL = -1;
 
-  Task(Node* loc_p, Node* loc_d, int t)
-      : id(TASK_ID_CNT++),
+  Task(int _id, Node* loc_p, Node* loc_d, int t)
+      : id(_id),
         loc_pickup(loc_p),
         loc_delivery(loc_d),
         loc_current(loc_p),
@@ -25,3 +23,21 @@ struct Task {
 };
 
 using Tasks = std::vector<Task*>;
+
+// change of target and assigned task of an agent, instead of whole histories
+struct TargetEvent {
+  int timestep;
+  int agent;
+  Node* target;
+  int task_id;  // Task::NIL for free agents
+};
+
+// change of a task, streamed instead of keeping whole histories
+struct TaskEvent {
+  enum Type { ASSIGNED = 0, PICKED = 1, DELIVERED = 2 };
+
+  Type type;
+  int task_id;
+  int agent;
+  int timestep;
+};
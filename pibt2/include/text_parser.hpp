@@ -0,0 +1,155 @@
+/*
+ * tokenizer for instance, scenario and pd files, used instead of std::regex
+ *
+ * Each function accepts exactly what the corresponding regex of the former
+ * loader matched; '.' of ECMAScript regex does not match CR/LF.
+ */
+
+#pragma once
+#include <charconv>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace TextParser
+{
+
+// read whole file at once, return false when the file cannot be opened
+[[maybe_unused]] static bool readFile(const std::string& filename,
+                                      std::string& buf)
+{
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) return false;
+  file.seekg(0, std::ios::end);
+  const auto size = file.tellg();
+  file.seekg(0, std::ios::beg);
+  buf.resize(size < 0 ? 0 : (size_t)size);
+  file.read(buf.data(), buf.size());
+  buf.resize(file.gcount());
+  return true;
+}
+
+// iterate lines like std::getline, CR at the end of line is removed
+class LineReader
+{
+private:
+  std::string_view buf;
+  size_t pos;
+
+public:
+  LineReader(std::string_view _buf) : buf(_buf), pos(0) {}
+
+  bool next(std::string_view& line)
+  {
+    if (pos >= buf.size()) return false;
+    size_t end = buf.find('\n', pos);
+    if (end == std::string_view::npos) end = buf.size();
+    line = buf.substr(pos, end - pos);
+    pos = end + 1;
+    if (!line.empty() && line.back() == 0x0d) line.remove_suffix(1);
+    return true;
+  }
+};
+
+// .+
+[[maybe_unused]] static bool isAny(std::string_view s)
+{
+  return !s.empty() && s.find_first_of("\r\n") == std::string_view::npos;
+}
+
+// \d+
+[[maybe_unused]] static bool isDigits(std::string_view s)
+{
+  if (s.empty()) return false;
+  for (auto c : s) {
+    if (c < '0' || '9' < c) return false;
+  }
+  return true;
+}
+
+// \d+, converted to int
+[[maybe_unused]] static bool parseInt(std::string_view s, int& x)
+{
+  if (!isDigits(s)) return false;
+  auto res = std::from_chars(s.data(), s.data() + s.size(), x);
+  return res.ec == std::errc() && res.ptr == s.data() + s.size();
+}
+
+// key=(.+), value is stored
+[[maybe_unused]] static bool matchKey(std::string_view line,
+                                      std::string_view key,
+                                      std::string_view& value)
+{
+  if (line.size() <= key.size() || line.substr(0, key.size()) != key ||
+      line[key.size()] != '=') {
+    return false;
+  }
+  value = line.substr(key.size() + 1);
+  return isAny(value);
+}
+
+// key=(\d+)
+[[maybe_unused]] static bool matchKey(std::string_view line,
+                                      std::string_view key, int& x)
+{
+  std::string_view value;
+  return matchKey(line, key, value) && parseInt(value, x);
+}
+
+// #.+
+[[maybe_unused]] static bool isComment(std::string_view line)
+{
+  return line.size() > 1 && line[0] == '#' && isAny(line.substr(1));
+}
+
+// (\d+),(\d+)
+[[maybe_unused]] static bool parsePos(std::string_view line, int& x, int& y)
+{
+  const size_t k = line.find(',');
+  if (k == std::string_view::npos) return false;
+  return parseInt(line.substr(0, k), x) && parseInt(line.substr(k + 1), y);
+}
+
+// one line of MovingAI scenario
+// \d+\t.+\.map\t\d+\t\d+\t(\d+)\t(\d+)\t(\d+)\t(\d+)\t.+
+// the map name may contain tabs, the longest one is taken as regex does
+[[maybe_unused]] static bool parseScenLine(std::string_view line, int& x_s,
+                                           int& y_s, int& x_g, int& y_g)
+{
+  if (!isAny(line)) return false;
+  size_t k = line.find('\t');
+  if (k == std::string_view::npos || !isDigits(line.substr(0, k))) {
+    return false;
+  }
+  const std::string_view rest = line.substr(k + 1);
+
+  // candidates of the end of map name, from the last one
+  size_t end = rest.size();
+  while (end > 0) {
+    const size_t p = rest.rfind(".map\t", end - 1);
+    if (p == std::string_view::npos) return false;
+    end = p;
+    if (p == 0) continue;  // map name needs one char before ".map"
+
+    // six integers and the remaining
+    std::string_view s = rest.substr(p + 5);
+    std::string_view fields[6];
+    bool ok = true;
+    for (int i = 0; i < 6 && ok; ++i) {
+      const size_t q = s.find('\t');
+      if (q == std::string_view::npos) {
+        ok = false;
+        break;
+      }
+      fields[i] = s.substr(0, q);
+      s = s.substr(q + 1);
+      ok = isDigits(fields[i]);
+    }
+    if (!ok || s.empty()) continue;
+    return parseInt(fields[2], x_s) && parseInt(fields[3], y_s) &&
+           parseInt(fields[4], x_g) && parseInt(fields[5], y_g);
+  }
+  return false;
+}
+
+};  // namespace TextParser
@@ -0,0 +1,37 @@
+#pragma once
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+ * fixed number of worker threads executing jobs in FIFO order
+ */
+class ThreadPool
+{
+private:
+  std::vector<std::thread> workers;
+  std::queue<std::function<void()>> jobs;
+  int running;  // jobs being executed
+  bool closing;
+  std::exception_ptr error;  // first exception thrown by jobs
+  std::mutex mtx;
+  std::condition_variable cv_job;   // new job or closing
+  std::condition_variable cv_idle;  // all jobs done
+
+  void work();  // main of each worker
+
+public:
+  // num_threads <= 0: number of hardware threads
+  ThreadPool(int num_threads = 0);
+  ~ThreadPool();
+
+  void submit(std::function<void()> job);
+  // block until all submitted jobs are done,
+  // then rethrow the first exception thrown by them if any
+  void wait();
+  int size() const { return workers.size(); }
+};
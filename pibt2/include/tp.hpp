@@ -1,4 +1,7 @@
 #pragma once
+#include <unordered_set>
+
+#include "reservation_table.hpp"
 #include "solver.hpp"
 
 class TP : public MAPD_Solver
@@ -6,7 +9,7 @@ class TP : public MAPD_Solver
 public:
   static const std::string SOLVER_NAME;
 
-private:
+protected:
   struct Agent {
     int id;
     Node* v_now;  // current location
@@ -15,12 +18,49 @@ private:
   };
   using Agents = std::vector<Agent*>;
 
+  // reset conflict table and indexes, with tokens of starts
+  void initialize(std::vector<Path>& TOKEN);
+
   void updatePath1(int i, Task* task, std::vector<Path>& TOKEN);
-  void updatePath2(int i, std::vector<Path>& TOKEN, Tasks& unassigned_tasks);
-  void updatePath(int i, Node* g, std::vector<Path>& TOKEN);
+  void updatePath2(int i, std::vector<Path>& TOKEN);
+  // nearest endpoint to park agent i in updatePath2, nullptr when none
+  Node* findEndpoint(int i, const std::vector<Path>& TOKEN);
+  // plan through waypoints in order and extend the token
+  void updatePath(int i, const Nodes& waypoints, std::vector<Path>& TOKEN);
+  // append path except the current tail, and update indexes
+  void extendToken(int i, const Nodes& path, std::vector<Path>& TOKEN);
+
+  ReservationTable CONFLICT_TABLE;  // time, node -> agent, from now on
+  static constexpr int NIL = ReservationTable::NIL;
+
+  // indexes by node id, updated with TOKEN and tasks
+  std::vector<int> token_tails;     // num of tokens ending at the node
+  std::vector<int> tail_agent;      // agent whose token ends there, or NIL
+  std::vector<int> last_reserved;   // latest timestep in tokens, NIL: none
+  std::vector<int> deliveries;      // num of unassigned tasks delivered there
+  int registered_task_num;          // tasks counted in deliveries so far
+  std::vector<int> endpoint_order;  // position in P->getEndpoints(), or NIL
+
+  // space-time A* in updatePath, storage is reused between calls
+  struct SearchNode {
+    Node* v;
+    int g;       // time from the start of the search
+    int f;
+    int stage;   // index of the next waypoint
+    int parent;  // index in search_nodes, NIL for the root
+  };
+  std::vector<SearchNode> search_nodes;
+  std::unordered_set<long long> search_closed;  // (node, time, stage)
+
+  // BFS in updatePath2, nodes with visited_stamp are visited
+  std::vector<int> visited;
+  int visited_stamp;
 
-  std::vector<std::vector<int>> CONFLICT_TABLE;  // time, node -> agent
-  static constexpr int NIL = -1;
+  // whether the token of other agent than i ends at v
+  bool isOthersTail(int i, Node* v, const std::vector<Path>& TOKEN) const
+  {
+    return token_tails[v->id] - (TOKEN[i].back() == v) > 0;
+  }
 
   // main
   void run();
@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+#include "nodes_view.hpp"
+
+/*
+ * trajectories of agents, stored as a contiguous buffer of 32-bit node ids
+ *
+ * Two layouts are available:
+ * - time-major, [t * num_agents + i], i.e., sequence of configurations
+ * - agent-major, [i * stride + t], i.e., array of paths of different lengths
+ * One of them is primary and modified directly; the other is created on
+ * demand and discarded by modifications.
+ * Views returned by getters are valid until the trajectories are modified.
+ */
+
+class Trajectories
+{
+public:
+  enum Layout { TIME_MAJOR, AGENT_MAJOR };
+
+private:
+  // node-id -> node, shared with copies
+  std::shared_ptr<Nodes> dict;
+
+  Layout primary;
+  int num_agents;
+
+  // time-major, paths are padded to 'horizon'
+  mutable std::vector<uint32_t> by_time;
+  mutable int horizon;
+
+  // agent-major
+  mutable std::vector<uint32_t> by_agent;
+  mutable std::vector<int> lengths;  // agent -> path length
+  mutable int stride;                // maximum path length in buffer
+
+  mutable bool synced;  // whether the secondary layout is up to date
+  void sync() const;
+
+  // register node to the dictionary
+  uint32_t encode(Node* v);
+
+  // reallocate agent-major buffer with new stride
+  void reserveStride(int new_stride);
+
+public:
+  Trajectories(Layout _primary = TIME_MAJOR, int _num_agents = 0);
+  ~Trajectories() {}
+
+  Layout getLayout() const { return primary; }
+  int getNumAgents() const { return num_agents; }
+
+  // number of timesteps, i.e., maximum path length
+  int getHorizon() const;
+
+  // change primary layout
+  void setLayout(Layout layout);
+
+  // become empty
+  void clear();
+
+  // -------------------------------
+  // time-major operations
+
+  // add new configuration to the last
+  void addConfig(const Nodes& c);
+
+  // timestep -> configuration
+  NodesView getConfig(int t) const;
+
+  // -------------------------------
+  // agent-major operations
+
+  // replace path of agent i
+  void setPath(int i, const Path& path);
+
+  // make path of agent i empty
+  void clearPath(int i);
+
+  // cutoff or pad path of agent i
+  void resizePath(int i, int len);
+
+  // length of path of agent i
+  int getPathLength(int i) const;
+
+  // agent -> path, padded to len
+  NodesView getPath(int i, int len) const;
+  NodesView getPath(int i) const { return getPath(i, getPathLength(i)); }
+
+  // -------------------------------
+  // both
+
+  // timestep, agent -> location, stay at the last location of the path
+  Node* get(int t, int i) const;
+
+  // error
+  void halt(const std::string& msg) const;
+};
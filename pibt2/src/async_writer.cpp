@@ -0,0 +1,89 @@
+#include "../include/async_writer.hpp"
+
+#include <iostream>
+
+AsyncWriter::AsyncWriter(const std::string& filename)
+    : fp(std::fopen(filename.c_str(), "wb")), closing(false), failed(false)
+{
+  if (fp == nullptr) halt("cannot open " + filename);
+  for (int k = 0; k < NUM_BUFFERS; ++k) {
+    buffers[k] = std::make_unique<char[]>(BUFFER_SIZE);
+    sizes[k] = 0;
+    if (k > 0) available.push_back(k);
+  }
+  current = 0;
+  head = buffers[0].get();
+  tail = head + BUFFER_SIZE;
+  worker = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter() { close(); }
+
+void AsyncWriter::run()
+{
+  while (true) {
+    int k;
+    {
+      std::unique_lock<std::mutex> lk(mtx);
+      cv.wait(lk, [&] { return !full.empty() || closing; });
+      if (full.empty()) return;  // closing
+      k = full.front();
+    }
+    if (std::fwrite(buffers[k].get(), 1, sizes[k], fp) != sizes[k]) {
+      failed = true;
+    }
+    {
+      std::lock_guard<std::mutex> lk(mtx);
+      full.pop_front();
+      available.push_back(k);
+    }
+    cv.notify_all();
+  }
+}
+
+void AsyncWriter::submit()
+{
+  std::unique_lock<std::mutex> lk(mtx);
+  sizes[current] = head - buffers[current].get();
+  full.push_back(current);
+  cv.notify_all();
+  cv.wait(lk, [&] { return !available.empty(); });
+  current = available.front();
+  available.pop_front();
+  head = buffers[current].get();
+  tail = head + BUFFER_SIZE;
+}
+
+void AsyncWriter::write(const char* str, size_t len)
+{
+  while (len > 0) {
+    if (head == tail) submit();
+    const size_t n = std::min(len, (size_t)(tail - head));
+    std::memcpy(head, str, n);
+    head += n;
+    str += n;
+    len -= n;
+  }
+}
+
+bool AsyncWriter::close()
+{
+  if (fp == nullptr) return !failed;
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    sizes[current] = head - buffers[current].get();
+    full.push_back(current);
+    closing = true;
+  }
+  cv.notify_all();
+  worker.join();
+  std::fclose(fp);
+  fp = nullptr;
+  head = tail = nullptr;
+  return !failed;
+}
+
+void AsyncWriter::halt(const std::string& msg) const
+{
+  throw std::runtime_error("error@AsyncWriter: " + msg);
+}
@@ -0,0 +1,51 @@
+#include "../include/distance_field_cache.hpp"
+
+#include <algorithm>
+
+#include "../include/target_distance_table.hpp"
+
+DistanceFieldCache::DistanceFieldCache(Graph* _G,
+                                       const std::size_t budget_bytes)
+    : G(_G),
+      capacity(std::max<std::size_t>(
+          1, std::min<std::size_t>(
+                 budget_bytes / (std::max(1, G->getNodesSize()) * sizeof(int)),
+                 G->getNodesSize()))),
+      entry_of(G->getNodesSize(), lru.end()),
+      hit_cnt(0),
+      miss_cnt(0),
+      eviction_cnt(0)
+{
+}
+
+int DistanceFieldCache::get(Node* const s, Node* const g)
+{
+  // undirected graph, use the field of s if only it is cached
+  if (!isCached(g) && isCached(s)) return getField(s)[g->id];
+  return getField(g)[s->id];
+}
+
+const std::vector<int>& DistanceFieldCache::getField(Node* const g)
+{
+  auto itr = entry_of[g->id];
+  if (itr != lru.end()) {
+    ++hit_cnt;
+    if (itr != lru.begin()) lru.splice(lru.begin(), lru, itr);
+    return itr->field;
+  }
+
+  ++miss_cnt;
+  if ((int)lru.size() < capacity) {
+    lru.emplace_front();
+  } else {
+    // recycle the least recently used field
+    ++eviction_cnt;
+    entry_of[lru.back().target->id] = lru.end();
+    lru.splice(lru.begin(), lru, std::prev(lru.end()));
+  }
+  auto& entry = lru.front();
+  entry.target = g;
+  TargetDistanceTable::computeField(G, g, entry.field);
+  entry_of[g->id] = lru.begin();
+  return entry.field;
+}
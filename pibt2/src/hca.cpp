@@ -82,7 +82,7 @@ Path HCA::getPrioritizedPath(int id, const Paths& paths)
   };
 
   const auto p = MAPF_Solver::getPrioritizedPath(
-      id, paths, getRemainedTime(), max_timestep, {}, compare, false);
+      id, paths, deadline, max_timestep, {}, compare, false);
 
   // update path table
   updatePathTableWithoutClear(id, p, paths);
@@ -96,9 +96,9 @@ void HCA::setParams(int argc, char* argv[])
       {"disable-dist-init", no_argument, 0, 'd'},
       {0, 0, 0, 0},
   };
-  optind = 1;  // reset
-  int opt, longindex;
-  while ((opt = getopt_long(argc, argv, "d", longopts, &longindex)) != -1) {
+  OptionScanner scanner(argc, argv, "d", longopts);
+  int opt;
+  while ((opt = scanner.next()) != -1) {
     switch (opt) {
       case 'd':
         disable_dist_init = true;
@@ -0,0 +1,108 @@
+#include "../include/option_scanner.hpp"
+
+#include <cstring>
+
+OptionScanner::OptionScanner(int _argc, char* const _argv[],
+                             const char* _optstring,
+                             const struct option* _longopts)
+    : argc(_argc),
+      argv(_argv),
+      optstring(_optstring),
+      longopts(_longopts),
+      index(1),
+      next_char(nullptr),
+      value(nullptr)
+{
+  // GNU extensions of the ordering, not used
+  if (*optstring == '+' || *optstring == '-') ++optstring;
+  if (*optstring == ':') ++optstring;
+}
+
+int OptionScanner::next()
+{
+  value = nullptr;
+  if (next_char != nullptr && *next_char != '\0') return scanShort();
+  next_char = nullptr;
+
+  while (index < argc) {
+    const char* a = argv[index];
+    if (a[0] != '-' || a[1] == '\0') {  // non-option
+      ++index;
+      continue;
+    }
+    if (a[1] == '-') {
+      if (a[2] == '\0') {  // "--", end of options
+        index = argc;
+        return -1;
+      }
+      return scanLong();
+    }
+    next_char = a + 1;
+    ++index;
+    return scanShort();
+  }
+  return -1;
+}
+
+int OptionScanner::scanShort()
+{
+  const char c = *next_char++;
+  const char* p = (c == ':') ? nullptr : std::strchr(optstring, c);
+  if (p == nullptr) return '?';
+  if (p[1] != ':') return c;
+
+  // with argument
+  if (*next_char != '\0') {
+    value = next_char;
+  } else if (p[2] == ':') {  // optional argument, only in the same element
+    value = nullptr;
+  } else if (index < argc) {
+    value = argv[index++];
+  } else {
+    next_char = nullptr;
+    return '?';
+  }
+  next_char = nullptr;
+  return c;
+}
+
+int OptionScanner::scanLong()
+{
+  const char* name = argv[index++] + 2;
+  const char* eq = std::strchr(name, '=');
+  const size_t len = (eq == nullptr) ? std::strlen(name) : eq - name;
+
+  // exact match first, otherwise unique prefix
+  const struct option* found = nullptr;
+  bool ambiguous = false;
+  for (auto o = longopts; o != nullptr && o->name != nullptr; ++o) {
+    if (std::strncmp(o->name, name, len) != 0) continue;
+    if (std::strlen(o->name) == len) {
+      found = o;
+      ambiguous = false;
+      break;
+    }
+    if (found == nullptr) {
+      found = o;
+    } else if (found->has_arg != o->has_arg || found->flag != o->flag ||
+               found->val != o->val) {
+      ambiguous = true;
+    }
+  }
+  if (found == nullptr || ambiguous) return '?';
+
+  if (found->has_arg == no_argument) {
+    if (eq != nullptr) return '?';
+  } else if (eq != nullptr) {
+    value = eq + 1;
+  } else if (found->has_arg == required_argument) {
+    if (index >= argc) return '?';
+    value = argv[index++];
+  }
+
+  if (found->flag != nullptr) {
+    *found->flag = found->val;
+    return 0;
+  }
+  return found->val;
+}
@@ -1,71 +1,98 @@
 #include "../include/paths.hpp"
 
+#include <algorithm>
+
 Paths::Paths(int num_agents)
+    : trajectories(Trajectories::AGENT_MAJOR, num_agents), makespan(0)
 {
-  std::vector<Path> tmp(num_agents, Path(0));
-  paths = tmp;
-  makespan = 0;
 }
 
-Path Paths::get(int i) const
+Paths::Paths(const Trajectories& _trajectories)
+    : trajectories(_trajectories), makespan(0)
 {
-  const int paths_size = paths.size();
-  if (!(0 <= i && i < paths_size)) halt("invalid index");
-  return paths[i];
+  trajectories.setLayout(Trajectories::AGENT_MAJOR);
+  makespan = std::max(0, trajectories.getHorizon() - 1);
+}
+
+NodesView Paths::get(int i) const
+{
+  if (!(0 <= i && i < size())) halt("invalid index");
+  return trajectories.getPath(i, makespan + 1);
 }
 
 Node* Paths::get(int i, int t) const
 {
-  if (!(0 <= i && i < (int)paths.size()) || !(0 <= t && t <= makespan)) {
+  if (!(0 <= i && i < size()) || !(0 <= t && t <= makespan) ||
+      trajectories.getPathLength(i) == 0) {
     halt("invalid index, i=" + std::to_string(i) + ", t=" + std::to_string(t));
   }
-  return paths[i][t];
+  return at(i, t);
 }
 
 Node* Paths::last(int i) const { return get(i, makespan); }
 
-bool Paths::empty() const { return paths.empty(); }
+bool Paths::empty() const { return size() == 0; }
 
 bool Paths::empty(const int i) const
 {
-  const int paths_size = paths.size();
-  if (!(0 <= i && i < paths_size))
-    halt("invalid index, i=" + std::to_string(i));
-  return paths[i].empty();
+  if (!(0 <= i && i < size())) halt("invalid index, i=" + std::to_string(i));
+  return trajectories.getPathLength(i) == 0;
 }
 
 void Paths::insert(int i, const Path& path)
 {
-  const int paths_size = paths.size();
+  const int paths_size = size();
   if (!(0 <= i && i < paths_size)) halt("invalid index");
   if (path.empty()) halt("path must not be empty");
-  const int old_len = paths[i].size();
-  paths[i] = path;
+  const int old_len = empty(i) ? 0 : makespan + 1;
+  const int old_makespan = makespan;
+  if (indexed && !empty(i)) unindexPath(i, 0, makespan);
+  trajectories.setPath(i, path);
   const int path_size = path.size();
-  if (path_size - 1 == getMakespan()) return;
-  format();                           // align each path size
-  if (path_size < old_len) shrink();  // cutoff additional configs
-  makespan = getMaxLengthPaths();     // update makespan
+  if (path_size - 1 != makespan) {
+    // update makespan, padding is implicit
+    bool others = false;
+    for (int j = 0; j < paths_size && !others; ++j) {
+      others = j != i && !empty(j);
+    }
+    makespan = others ? std::max(makespan, path_size - 1) : path_size - 1;
+    if (path_size < old_len) shrink();  // cutoff additional configs
+  }
+  if (!indexed) return;
+
+  // update occupancy index
+  occupancy.resize(makespan + 1);
+  if (makespan > old_makespan) {  // others wait at their last locations
+    for (int j = 0; j < paths_size; ++j) {
+      if (j != i && !empty(j)) indexPath(j, old_makespan + 1, makespan);
+    }
+  }
+  indexPath(i, 0, makespan);
 }
 
-void Paths::clear(int i) { paths[i].clear(); }
+void Paths::clear(int i)
+{
+  if (indexed && !empty(i)) unindexPath(i, 0, makespan);
+  trajectories.clearPath(i);
+}
 
-int Paths::size() const { return paths.size(); }
+int Paths::size() const { return trajectories.getNumAgents(); }
 
 void Paths::operator+=(const Paths& other)
 {
   if (other.empty()) return;
-  if (paths.size() != other.paths.size()) halt("invalid operation");
-  const int paths_size = paths.size();
+  if (size() != other.size()) halt("invalid operation");
+  const int paths_size = size();
   if (makespan == 0) {  // empty
     for (int i = 0; i < paths_size; ++i) insert(i, other.get(i));
   } else {
     std::vector<Path> new_paths(paths_size);
     for (int i = 0; i < paths_size; ++i) {
-      if (paths[i].empty() || *(paths[i].end() - 1) != other.paths[i][0]) {
+      if (empty(i) || other.empty(i) || last(i) != other.get(i, 0)) {
         halt("invalid operation");
       }
       Path tmp;
+      tmp.reserve(getMakespan() + other.getMakespan() + 1);
       // former
       for (int t = 0; t <= getMakespan(); ++t) {
         tmp.push_back(get(i, t));
@@ -83,66 +110,52 @@ void Paths::operator+=(const Paths& other)
 // this func is used when updating makespan
 int Paths::getMaxLengthPaths() const
 {
-  int max_val = 0;
-  for (auto p : paths) {
-    if (p.empty()) continue;
-    const int p_size = p.size();
-    max_val = (p_size - 1 > max_val) ? p_size - 1 : max_val;
-  }
-  return max_val;
+  return std::max(0, trajectories.getHorizon() - 1);
 }
 
 int Paths::getMakespan() const { return makespan; }
 
 int Paths::costOfPath(int i) const
 {
-  const int paths_size = paths.size();
-  if (!(0 <= i && i < paths_size)) {
-    halt("invalid index " + std::to_string(i));
-  }
+  if (!(0 <= i && i < size())) halt("invalid index " + std::to_string(i));
   return getPathCost(get(i));
 }
 
 int Paths::getSOC() const
 {
   int soc = 0;
-  const int paths_size = paths.size();
+  const int paths_size = size();
   for (int i = 0; i < paths_size; ++i) soc += costOfPath(i);
   return soc;
 }
 
 void Paths::format()
 {
-  const int paths_size = paths.size();
-  int len = getMaxLengthPaths();
+  const int paths_size = size();
   for (int i = 0; i < paths_size; ++i) {
-    if (paths[i].empty()) continue;
-    int p_size = paths[i].size();
-    while (p_size - 1 != len) {
-      paths[i].push_back(*(paths[i].end() - 1));
-      ++p_size;
-    }
+    if (!empty(i)) trajectories.resizePath(i, makespan + 1);
   }
 }
 
 void Paths::shrink()
 {
-  const int paths_size = paths.size();
-  while (true) {
-    bool shrinkable = true;
-    for (auto p : paths) {
-      if (p.size() <= 1 || *(p.end() - 1) != *(p.end() - 2)) {
-        shrinkable = false;
-        break;
-      }
-    }
-    if (!shrinkable) break;
-
-    // remove additional configuration
-    for (int i = 0; i < paths_size; ++i) {
-      paths[i].resize(paths[i].size() - 1);
+  // timesteps are removable only when all agents stay there
+  const int paths_size = size();
+  for (int i = 0; i < paths_size; ++i) {
+    if (empty(i)) return;
+  }
+  int len = 0;
+  for (int i = 0; i < paths_size; ++i) {
+    len = std::max(len, getPathCost(trajectories.getPath(i)));
+  }
+  if (len >= makespan) return;
+  for (int i = 0; i < paths_size; ++i) {
+    if (trajectories.getPathLength(i) > len + 1) {
+      trajectories.resizePath(i, len + 1);
     }
   }
+  makespan = len;
+  if (indexed) occupancy.resize(makespan + 1);
 }
 
 bool Paths::conflicted(int i, int j, int t) const
@@ -154,69 +167,133 @@ bool Paths::conflicted(int i, int j, int t) const
   return false;
 }
 
-int Paths::countConflict() const
+void Paths::buildIndex() const
 {
-  int cnt = 0;
-  int num_agents = size();
-  int makespan = getMakespan();
-  for (int i = 0; i < num_agents; ++i) {
-    for (int j = i + 1; j < num_agents; ++j) {
-      for (int t = 1; t <= makespan; ++t) {
-        if (conflicted(i, j, t)) ++cnt;
+  occupancy.assign(makespan + 1, std::unordered_multimap<int, int>());
+  const int paths_size = size();
+  for (int i = 0; i < paths_size; ++i) {
+    if (!empty(i)) indexPath(i, 0, makespan);
+  }
+  indexed = true;
+}
+
+void Paths::indexPath(int i, int t_from, int t_to) const
+{
+  for (int t = t_from; t <= t_to; ++t) {
+    occupancy[t].emplace(at(i, t)->id, i);
+  }
+}
+
+void Paths::unindexPath(int i, int t_from, int t_to) const
+{
+  for (int t = t_from; t <= t_to; ++t) {
+    auto range = occupancy[t].equal_range(at(i, t)->id);
+    for (auto itr = range.first; itr != range.second; ++itr) {
+      if (itr->second == i) {
+        occupancy[t].erase(itr);
+        break;
       }
     }
   }
-  return cnt;
 }
 
-int Paths::countConflict(const std::vector<int>& sample) const
+void Paths::findConflicts(const std::vector<bool>& mask,
+                          const std::function<void(int, int, int)>& f) const
 {
-  int cnt = 0;
-  int makespan = getMakespan();
-  const int sample_size = sample.size();
-  for (int i = 0; i < sample_size; ++i) {
-    for (int j = i + 1; j < sample_size; ++j) {
-      for (int t = 1; t <= makespan; ++t) {
-        if (conflicted(sample[i], sample[j], t)) ++cnt;
+  if (!indexed) buildIndex();
+  const int paths_size = size();
+  for (int i = 0; i < paths_size; ++i) {
+    if (!mask[i] || empty(i)) continue;
+    for (int t = 1; t <= makespan; ++t) {
+      Node* v = at(i, t);
+      Node* u = at(i, t - 1);
+      // vertex conflict
+      auto range = occupancy[t].equal_range(v->id);
+      for (auto itr = range.first; itr != range.second; ++itr) {
+        const int j = itr->second;
+        if (j > i && mask[j]) f(i, j, t);
+      }
+      // swap conflict, exclusive with vertex conflicts
+      if (u == v) continue;
+      range = occupancy[t - 1].equal_range(v->id);
+      for (auto itr = range.first; itr != range.second; ++itr) {
+        const int j = itr->second;
+        if (j > i && mask[j] && at(j, t) == u) f(i, j, t);
       }
     }
   }
+}
+
+int Paths::countConflict() const
+{
+  int cnt = 0;
+  findConflicts(std::vector<bool>(size(), true),
+                [&](int, int, int) { ++cnt; });
+  return cnt;
+}
+
+int Paths::countConflict(const std::vector<int>& sample) const
+{
+  int cnt = 0;
+  std::vector<bool> mask(size(), false);
+  for (auto i : sample) mask[i] = true;
+  findConflicts(mask, [&](int, int, int) { ++cnt; });
   return cnt;
 }
 
 int Paths::countConflict(int id, const Path& path) const
 {
+  if (!indexed) buildIndex();
   int cnt = 0;
-  int makespan = getMakespan();
-  int num_agents = size();
   const int path_size = path.size();
-  for (int i = 0; i < num_agents; ++i) {
-    if (i == id) continue;
-    for (int t = 1; t < path_size; ++t) {
-      if (t > makespan) {
-        if (path[t] == get(i, makespan)) {
-          ++cnt;
-          break;
-        }
-        continue;
-      }
-      // vertex conflict
-      if (get(i, t) == path[t]) {
-        ++cnt;
-        continue;
-      }
-      // swap conflict
-      if (get(i, t) == path[t - 1] && get(i, t - 1) == path[t]) ++cnt;
+  for (int t = 1; t < path_size && t <= makespan; ++t) {
+    // vertex conflict
+    auto range = occupancy[t].equal_range(path[t]->id);
+    for (auto itr = range.first; itr != range.second; ++itr) {
+      if (itr->second != id) ++cnt;
+    }
+    // swap conflict
+    if (path[t] == path[t - 1]) continue;
+    range = occupancy[t - 1].equal_range(path[t]->id);
+    for (auto itr = range.first; itr != range.second; ++itr) {
+      const int j = itr->second;
+      if (j != id && at(j, t) == path[t - 1]) ++cnt;
+    }
+  }
+  // others staying at their last locations, counted once per agent
+  std::unordered_map<int, bool> checked;
+  for (int t = makespan + 1; t < path_size; ++t) {
+    if (!checked.emplace(path[t]->id, true).second) continue;
+    auto range = occupancy[makespan].equal_range(path[t]->id);
+    for (auto itr = range.first; itr != range.second; ++itr) {
+      if (itr->second != id) ++cnt;
     }
   }
   return cnt;
 }
 
+std::vector<std::tuple<int, int, int>> Paths::getConflicts() const
+{
+  std::vector<std::tuple<int, int, int>> conflicts;
+  findConflicts(std::vector<bool>(size(), true),
+                [&](int i, int j, int t) { conflicts.emplace_back(i, j, t); });
+  return conflicts;
+}
+
+std::vector<std::tuple<int, int, int>> Paths::getConflicts(
+    const std::vector<int>& sample) const
+{
+  std::vector<std::tuple<int, int, int>> conflicts;
+  std::vector<bool> mask(size(), false);
+  for (auto i : sample) mask[i] = true;
+  findConflicts(mask,
+                [&](int i, int j, int t) { conflicts.emplace_back(i, j, t); });
+  return conflicts;
+}
+
 void Paths::halt(const std::string& msg) const
 {
-  std::cout << "error@Paths: " << msg << std::endl;
-  this->~Paths();
-  std::exit(1);
+  throw std::runtime_error("error@Paths: " + msg);
 }
 
 void Paths::warn(const std::string& msg) const
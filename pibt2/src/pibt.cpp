@@ -1,5 +1,7 @@
 #include "../include/pibt.hpp"
 
+#include <fstream>
+
 const std::string PIBT::SOLVER_NAME = "PIBT";
 
 PIBT::PIBT(MAPF_Instance* _P)
@@ -63,7 +65,8 @@ void PIBT::run()
     A.push_back(a);
     occupied_now[s->id] = a;
   }
-  solution.add(P->getConfigStart());
+  solution.setSummaryOnly(summary_only);
+  appendConfig(P->getConfigStart());
 
 
   // main loop
@@ -71,6 +74,23 @@ void PIBT::run()
   int timestep = 0;
   float random_number = 0;
 
+  // progress monitor
+  // A step makes progress when it reaches a new best of either the number of
+  // agents at their goals or the sum of distances to goals. Revisiting an
+  // earlier configuration can never satisfy this, so livelocks count as
+  // stalls as well.
+  int best_reached = 0;
+  int best_sum_d = 0;
+  for (auto a : A) best_sum_d += a->curr_d;
+  int stall = 0;
+
+  // livelock detection
+  uint64_t hash = 0;
+  for (auto a : A) hash ^= getZobristKey(a->id, a->v_now);
+  std::vector<uint64_t> history(HISTORY_SIZE, hash);
+  int history_head = 0;
+  int revisit = 0;  // consecutive steps reaching known configurations
+
 
 
 
@@ -128,11 +148,17 @@ void PIBT::run()
 
     // acting
     bool check_goal_cond = true;
+    int reached = 0;
+    int sum_d = 0;
     Config config(P->getNum(), nullptr);
     for (auto a : A) {
       // clear
       if (occupied_now[a->v_now->id] == a) occupied_now[a->v_now->id] = nullptr;
       occupied_next[a->v_next->id] = nullptr;
+      // update hash, only for moved agents
+      if (a->v_now != a->v_next) {
+        hash ^= getZobristKey(a->id, a->v_now) ^ getZobristKey(a->id, a->v_next);
+      }
       // set next location
       config[a->id] = a->v_next;
       occupied_now[a->v_next->id] = a;
@@ -150,29 +176,63 @@ void PIBT::run()
 
       // update current distance
       a->curr_d = nodeDist(a->g, a->v_now);
+
+      // for progress monitor
+      if (a->v_now == a->g) ++reached;
+      sum_d += a->curr_d;
     }
 
 
     // update plan
-    solution.add(config);
+    appendConfig(config);
 
     ++timestep;
 
     // success
     if (check_goal_cond) {
       solved = true;
+      termination = "solved";
       break;
     }
 
-//    // failed
-//    if (timestep >= max_timestep || overCompTime()) {
-//      break;
-//    }
-
     // failed
     if (timestep >= max_timestep) {
+      termination = "max_timestep";
       break;
     }
+    if (overCompTime()) {
+      termination = deadline.isCancelled() ? "cancelled" : "timeout";
+      break;
+    }
+
+    // check progress
+    if (reached > best_reached || sum_d < best_sum_d) {
+      best_reached = std::max(best_reached, reached);
+      best_sum_d = std::min(best_sum_d, sum_d);
+      stall = 0;
+    } else if (stall_limit > 0 && ++stall >= stall_limit) {
+      termination = "stall";
+      info(" ", "no progress for", stall, "steps, give up at timestep",
+           timestep);
+      break;
+    }
+
+    // check cycles
+    if (cycle_limit > 0) {
+      if (std::find(history.begin(), history.end(), hash) != history.end()) {
+        ++revisit;
+      } else {
+        revisit = 0;
+      }
+      history[history_head] = hash;
+      history_head = (history_head + 1) % HISTORY_SIZE;
+      if (revisit >= cycle_limit) {
+        termination = "cycle";
+        info(" ", "detect cycle of configurations, give up at timestep",
+             timestep);
+        break;
+      }
+    }
   }
 
   // memory clear
@@ -185,8 +245,8 @@ bool PIBT::funcPIBT(Agent* ai, Agent* aj)
   auto compare = [&](Node* const v, Node* const u) {
     int d_v = nodeDist(ai->g, v);
     int d_u = nodeDist(ai->g, u);
-    int flex_v = flex_table[ai->g->id][v->id];
-    int flex_u = flex_table[ai->g->id][u->id];
+    int flex_v = (*flex_table)[ai->g->id][v->id];
+    int flex_u = (*flex_table)[ai->g->id][u->id];
 
     if (d_v != d_u) return d_v < d_u;
 
@@ -237,19 +297,42 @@ bool PIBT::funcPIBT(Agent* ai, Agent* aj)
 
 
 
+uint64_t PIBT::getZobristKey(const int i, Node* const v) const
+{
+  // splitmix64, no need to store a table of agents x nodes
+  uint64_t z = ((uint64_t)i << 32 | (uint32_t)v->id) + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+void PIBT::makeLogBasicInfo(std::ostream& log)
+{
+  MAPF_Solver::makeLogBasicInfo(log);
+  log << "termination=" << termination << "\n";
+}
+
 void PIBT::setParams(int argc, char* argv[])
 {
   struct option longopts[] = {
       {"disable-dist-init", no_argument, 0, 'd'},
+      {"stall-limit", required_argument, 0, 'k'},
+      {"cycle-limit", required_argument, 0, 'c'},
       {0, 0, 0, 0},
   };
-  optind = 1;  // reset
-  int opt, longindex;
-  while ((opt = getopt_long(argc, argv, "d", longopts, &longindex)) != -1) {
+  OptionScanner scanner(argc, argv, "dk:c:", longopts);
+  int opt;
+  while ((opt = scanner.next()) != -1) {
     switch (opt) {
       case 'd':
         disable_dist_init = true;
         break;
+      case 'k':
+        stall_limit = std::atoi(scanner.arg());
+        break;
+      case 'c':
+        cycle_limit = std::atoi(scanner.arg());
+        break;
       default:
         break;
     }
@@ -262,5 +345,15 @@ void PIBT::printHelp()
             << "  -d --disable-dist-init"
             << "        "
             << "disable initialization of priorities "
-            << "using distance from starts to goals" << std::endl;
+            << "using distance from starts to goals\n"
+            << "  -k --stall-limit [INT]"
+            << "        "
+            << "give up when no progress is made "
+            << "for this many steps (default: " << DEFAULT_STALL_LIMIT
+            << ", 0: disabled)\n"
+            << "  -c --cycle-limit [INT]"
+            << "        "
+            << "give up when only known configurations appear "
+            << "for this many steps, heuristic (default: "
+            << DEFAULT_CYCLE_LIMIT << ", 0: disabled)" << std::endl;
 }
@@ -5,7 +5,8 @@ const std::string PIBT_MAPD::SOLVER_NAME = "PIBT";
 PIBT_MAPD::PIBT_MAPD(MAPD_Instance* _P, bool _use_distance_table)
     : MAPD_Solver(_P, _use_distance_table),
       occupied_now(Agents(G->getNodesSize(), nullptr)),
-      occupied_next(Agents(G->getNodesSize(), nullptr))
+      occupied_next(Agents(G->getNodesSize(), nullptr)),
+      pickups(G)
 {
   solver_name = PIBT_MAPD::SOLVER_NAME;
 }
@@ -39,15 +40,20 @@ void PIBT_MAPD::run()
     A.push_back(a);
     occupied_now[s->id] = a;
   }
-  solution.add(P->getConfigStart());
+  solution.setSummaryOnly(summary_only);
+  appendConfig(P->getConfigStart());
 
-  auto assign = [&](Agent* a, Task* task) {
+  // at pickup location, task is picked as soon as assigned
+  auto assign = [&](Agent* a, Task* task, const int t) {
     a->task = task;
     a->target_task = nullptr;
     a->task->assigned = true;
     a->g = task->loc_delivery;  // update destination
+    pickups.remove(task);
     info("   ", "assign task-", a->task->id, ": agent-", a->id, ", ",
          a->task->loc_pickup->id, " -> ", a->task->loc_delivery->id);
+    appendTaskEvent(TaskEvent::ASSIGNED, task, a->id, t);
+    appendTaskEvent(TaskEvent::PICKED, task, a->id, t);
   };
 
   // main loop
@@ -60,9 +66,11 @@ void PIBT_MAPD::run()
 
     // target assignment
     {
-      Tasks unassigned_tasks;
+      // new tasks, with random tie-breakers between equidistant ones
       for (auto task : P->getOpenTasks()) {
-        if (!task->assigned) unassigned_tasks.push_back(task);
+        if (!task->assigned && !pickups.contains(task)) {
+          pickups.add(task, getRandomFloat(0, 1, MT));
+        }
       }
 
       // for log
@@ -78,28 +86,14 @@ void PIBT_MAPD::run()
         }
 
         // free agent, find min_distance pickup location
-
-        // setup
-        a->target_task = nullptr;
         a->g = a->v_now;
-        int min_d = P->getG()->getNodesSize();
-
-        std::shuffle(unassigned_tasks.begin(), unassigned_tasks.end(), *MT);
-        for (auto itr = unassigned_tasks.begin(); itr != unassigned_tasks.end();
-             ++itr) {
-          auto task = *itr;
-          int d = pathDist(a->v_now, task->loc_pickup);
-          if (d == 0) {
+        a->target_task = pickups.getNearest(a->v_now);
+        if (a->target_task != nullptr) {
+          if (pickups.getDist(a->v_now) == 0) {
             // special case, assign task directly
-            assign(a, task);
-            unassigned_tasks.erase(itr);  // remove from unassigned_tasks
-            break;
-          }
-
-          if (d < min_d) {
-            min_d = d;
-            a->g = task->loc_pickup;
-            a->target_task = task;
+            assign(a, a->target_task, P->getCurrentTimestep());
+          } else {
+            a->g = a->target_task->loc_pickup;
           }
         }
 
@@ -107,8 +101,7 @@ void PIBT_MAPD::run()
         tasks.push_back(a->task);
       }
 
-      hist_targets.push_back(targets);
-      hist_tasks.push_back(tasks);
+      appendTargets(targets, tasks);
     }
 
     // planning
@@ -147,6 +140,8 @@ void PIBT_MAPD::run()
         if (a->task->loc_current == a->task->loc_delivery) {
           info("   ", "finish task-", a->task->id, ": agent-", a->id, ", ",
                a->task->loc_pickup->id, " -> ", a->task->loc_delivery->id);
+          appendTaskEvent(TaskEvent::DELIVERED, a->task, a->id,
+                          P->getCurrentTimestep() + 1);
 
           a->task = nullptr;
         }
@@ -154,13 +149,13 @@ void PIBT_MAPD::run()
       } else if (a->target_task != nullptr) {  // free agent
         // assign
         if (a->target_task->loc_pickup == a->v_now) {
-          assign(a, a->target_task);
+          assign(a, a->target_task, P->getCurrentTimestep() + 1);
         }
       }
     }
 
     // update plan
-    solution.add(config);
+    appendConfig(config);
 
     // increment timestep
     P->update();
@@ -186,8 +181,7 @@ void PIBT_MAPD::run()
       targets[a->id] = a->g;
       tasks[a->id] = a->task;
     }
-    hist_targets.push_back(targets);
-    hist_tasks.push_back(tasks);
+    appendTargets(targets, tasks);
   }
 
   // memory clear
@@ -196,35 +190,43 @@ void PIBT_MAPD::run()
 
 bool PIBT_MAPD::funcPIBT(Agent* ai, Agent* aj)
 {
-  // compare two nodes
-  auto compare = [&](Node* const v, Node* const u) {
-    int d_v = pathDist(v, ai->g);
-    int d_u = pathDist(u, ai->g);
-     int flex_v = evalFlex(v, ai);
-     int flex_u = evalFlex(u, ai);
+  // candidate with its keys, evaluated once before sorting
+  struct Candidate {
+    Node* v;
+    int d;          // distance to goal
+    int flex;       // flexibility
+    bool occupied;  // occupied now
+  };
 
-    if (d_v != d_u) return d_v < d_u;
+  // compare two nodes
+  auto compare = [&](const Candidate& v, const Candidate& u) {
+    if (v.d != u.d) return v.d < u.d;
 
-     if (flex_v != flex_u) return flex_v > flex_u;
+    if (v.flex != u.flex) return v.flex > u.flex;
 
     // tie break
-    if (occupied_now[v->id] != nullptr && occupied_now[u->id] == nullptr)
-      return false;
-    if (occupied_now[v->id] == nullptr && occupied_now[u->id] != nullptr)
-      return true;
+    if (v.occupied && !u.occupied) return false;
+    if (!v.occupied && u.occupied) return true;
     // randomize
     return false;
   };
 
   // get candidates
-  Nodes C = ai->v_now->neighbor;
-  C.push_back(ai->v_now);
+  Nodes N = ai->v_now->neighbor;
+  N.push_back(ai->v_now);
   // randomize
-  std::shuffle(C.begin(), C.end(), *MT);
+  std::shuffle(N.begin(), N.end(), *MT);
+  std::vector<Candidate> C;
+  C.reserve(N.size());
+  for (auto v : N) {
+    C.push_back({v, pathDist(v, ai->g), evalFlex(v, ai),
+                 occupied_now[v->id] != nullptr});
+  }
   // sort
   std::sort(C.begin(), C.end(), compare);
 
-  for (auto u : C) {
+  for (auto& c : C) {
+    Node* u = c.v;
     // avoid conflicts
     if (occupied_next[u->id] != nullptr) continue;
     if (aj != nullptr && u == aj->v_now) continue;
@@ -249,53 +251,29 @@ bool PIBT_MAPD::funcPIBT(Agent* ai, Agent* aj)
 
 void PIBT_MAPD::printHelp() { printHelpWithoutOption(SOLVER_NAME); }
 
-
-
 // evaluate flexibility for a node to an agent
 int PIBT_MAPD::evalFlex(Node* a_node, Agent* a)
 {
-  auto compare_node = [&](Node* const v, Node* const u) {
-    int d_v = pathDist(v, a->g);
-    int d_u = pathDist(u, a->g);
-
-
-    if (d_v != d_u) return d_v < d_u;
-
-    return false;
-  };
-
   Nodes C = a_node->neighbor;
   C.push_back(a_node);
 
+  // distances to goal, each queried once
+  std::vector<int> dists(C.size());
+  for (int k = 0; k < (int)C.size(); ++k) dists[k] = pathDist(C[k], a->g);
+  const int min_dis = *std::min_element(dists.begin(), dists.end());
 
-  std::sort(C.begin(), C.end(), compare_node);
-
-  volatile int min_dis = pathDist(C[0], a->g);
-  volatile int final_value = 0;
-  int current_dis = 0;
-
-
-  for (auto v : C)
-  {
+  int final_value = 0;
+  for (int k = 0; k < (int)C.size(); ++k) {
     // give zero mark if occupied by another agent in next step
-    if (occupied_next[v->id] != nullptr) continue;
-
-    current_dis = pathDist(v, a->g);
+    if (occupied_next[C[k]->id] != nullptr) continue;
 
-    if ((current_dis - min_dis) == 0)
-    {
+    const int diff = dists[k] - min_dis;
+    if (diff == 0) {
       final_value = final_value + 2;
-    }
-    else if ((current_dis - min_dis) == 1)
-    {
+    } else if (diff == 1) {
       final_value = final_value + 1;
     }
-    else if ((current_dis - min_dis) == 2)
-    {
-      final_value = final_value + 0;
-    }
   }
 
   return final_value;
-
 }
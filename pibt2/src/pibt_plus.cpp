@@ -12,25 +12,30 @@ PIBT_PLUS::PIBT_PLUS(MAPF_Instance* _P) : MAPF_Solver(_P)
 {
   solver_name = SOLVER_NAME;
   comp_time_complement = 0;
+  stall_limit = DEFAULT_STALL_LIMIT;
 }
 
 void PIBT_PLUS::run()
 {
-  // find lower bound of makespan
-  int LB_makespan = 0;
-  for (int i = 0; i < P->getNum(); ++i) {
-    if (pathDist(i) > LB_makespan) LB_makespan = pathDist(i);
-  }
+  // nested plans are complete when streamed, summarized after streaming
+  const bool nested_summary_only = summary_only && plan_stream == nullptr;
 
-  // solve by PIBT
+  // solve by PIBT, as long as it keeps making progress
   auto _P = MAPF_Instance(P, P->getConfigStart(), P->getConfigGoal(),
-                          max_comp_time, LB_makespan);
+                          max_comp_time, max_timestep);
   auto init_solver = std::make_unique<PIBT>(&_P);
-  init_solver->setDistanceTable(
-      (distance_table_p == nullptr) ? &distance_table : distance_table_p);
-  info(" ", "run PIBT until timestep", LB_makespan);
+  init_solver->setDistanceTable(distance_table);
+  init_solver->setFlexTable(flex_table);
+  init_solver->setStallLimit(stall_limit);
+  init_solver->setSummaryOnly(nested_summary_only);
+  init_solver->setDeadline(deadline);
+  info(" ", "run PIBT until no progress for", stall_limit, "steps");
   init_solver->solve();
   solution = init_solver->getSolution();
+  if (plan_stream != nullptr) flushPlanStream();
+  solution.setSummaryOnly(summary_only);
+  info(" ", "PIBT stopped at timestep", solution.getMakespan(), "by",
+       init_solver->getTermination());
 
   if (init_solver->succeed()) {  // PIBT success
     solved = true;
@@ -41,40 +46,65 @@ void PIBT_PLUS::run()
 
     // solved by Push & Swap
     auto _Q = MAPF_Instance(P, solution.last(), P->getConfigGoal(),
-                            getRemainedTime(), max_timestep - LB_makespan);
+                            getRemainedTime(),
+                            max_timestep - solution.getMakespan());
     auto comp_solver = std::make_shared<PushAndSwap>(&_Q);
 
     // set solver options
-    comp_solver->setDistanceTable(
-        (distance_table_p == nullptr) ? &distance_table : distance_table_p);
+    comp_solver->setDistanceTable(distance_table);
+    comp_solver->setSummaryOnly(nested_summary_only);
+    comp_solver->setDeadline(deadline);
 
     info(" ", "elapsed:", getSolverElapsedTime(), ", use",
          comp_solver->getSolverName(), "to complement the remain");
 
     // solve
     comp_solver->solve();
-    solution += comp_solver->getSolution();
+    if (plan_stream == nullptr) {
+      solution += comp_solver->getSolution();
+    } else {
+      const Plan plan = comp_solver->getSolution();
+      for (int t = 1; t < plan.size(); ++t) appendConfig(plan.get(t));
+    }
     if (comp_solver->succeed()) solved = true;
 
     comp_time_complement = getElapsedTime(t_complement);
   }
 }
 
+void PIBT_PLUS::setParams(int argc, char* argv[])
+{
+  struct option longopts[] = {
+      {"stall-limit", required_argument, 0, 'k'},
+      {0, 0, 0, 0},
+  };
+  OptionScanner scanner(argc, argv, "k:", longopts);
+  int opt;
+  while ((opt = scanner.next()) != -1) {
+    switch (opt) {
+      case 'k':
+        stall_limit = std::atoi(scanner.arg());
+        break;
+      default:
+        break;
+    }
+  }
+}
+
 void PIBT_PLUS::printHelp()
 {
   std::cout << PIBT_PLUS::SOLVER_NAME << "\n"
-            << "  (none)" << std::endl;
+            << "  -k --stall-limit [INT]"
+            << "        "
+            << "switch to Push & Swap when PIBT makes no progress "
+            << "for this many steps (default: " << DEFAULT_STALL_LIMIT << ")"
+            << std::endl;
 }
 
-void PIBT_PLUS::makeLog(const std::string& logfile)
+void PIBT_PLUS::makeLogBasicInfo(std::ostream& log)
 {
-  std::ofstream log;
-  log.open(logfile, std::ios::out);
-  makeLogBasicInfo(log);
+  MAPF_Solver::makeLogBasicInfo(log);
 
   // print additional info
   log << "comp_time_complement=" << comp_time_complement << "\n";
-
-  makeLogSolution(log);
-  log.close();
 }
@@ -0,0 +1,110 @@
+#include "../include/pickup_field.hpp"
+
+#include <algorithm>
+#include <queue>
+#include <tuple>
+
+PickupField::PickupField(Graph* _G)
+    : G(_G),
+      sources(G->getNodesSize()),
+      dist(G->getNodesSize(), -1),
+      task(G->getNodesSize(), nullptr),
+      key_of(G->getNodesSize(), 0)
+{
+}
+
+bool PickupField::better(const int d, const Entry& e, const int v) const
+{
+  if (dist[v] == -1) return true;
+  return std::make_tuple(d, e.key, e.task->id) <
+         std::make_tuple(dist[v], key_of[v], task[v]->id);
+}
+
+void PickupField::set(const int d, const Entry& e, const int v)
+{
+  dist[v] = d;
+  task[v] = e.task;
+  key_of[v] = e.key;
+}
+
+void PickupField::add(Task* t, const float key)
+{
+  if (contains(t)) return;
+  keys[t] = key;
+  const Entry e = {t, key};
+  Node* s = t->loc_pickup;
+  sources[s->id].push_back(e);
+  if (!better(0, e, s->id)) return;
+
+  // nodes not improved block the wave, their neighbors are no better via s
+  set(0, e, s->id);
+  Nodes frontier = {s}, next;
+  for (int d = 1; !frontier.empty(); ++d) {
+    next.clear();
+    for (auto v : frontier) {
+      for (auto u : v->neighbor) {
+        if (!better(d, e, u->id)) continue;
+        set(d, e, u->id);
+        next.push_back(u);
+      }
+    }
+    std::swap(frontier, next);
+  }
+}
+
+void PickupField::remove(Task* t)
+{
+  auto itr = keys.find(t);
+  if (itr == keys.end()) return;
+  keys.erase(itr);
+  Node* s = t->loc_pickup;
+  auto& here = sources[s->id];
+  here.erase(std::find_if(here.begin(), here.end(),
+                          [&](const Entry& e) { return e.task == t; }));
+  if (task[s->id] != t) return;
+
+  // nodes taking t form a tree of shortest paths from s, cleared task marks
+  // visited ones
+  Nodes region = {s};
+  task[s->id] = nullptr;
+  for (int k = 0; k < (int)region.size(); ++k) {
+    Node* v = region[k];
+    for (auto u : v->neighbor) {
+      if (task[u->id] == t && dist[u->id] == dist[v->id] + 1) {
+        task[u->id] = nullptr;
+        region.push_back(u);
+      }
+    }
+  }
+  for (auto v : region) dist[v->id] = -1;
+
+  // other nodes keep their values; repair the region from its boundary and
+  // pickup locations inside, in order of (distance, key, id)
+  using Item = std::tuple<int, float, int, Node*>;
+  std::priority_queue<Item, std::vector<Item>, std::greater<Item>> OPEN;
+  auto push = [&](const int d, const Entry& e, Node* v) {
+    if (!better(d, e, v->id)) return;
+    set(d, e, v->id);
+    OPEN.emplace(d, e.key, e.task->id, v);
+  };
+  for (auto v : region) {
+    for (auto& e : sources[v->id]) push(0, e, v);
+    for (auto u : v->neighbor) {
+      if (dist[u->id] == -1) continue;
+      push(dist[u->id] + 1, {task[u->id], key_of[u->id]}, v);
+    }
+  }
+  while (!OPEN.empty()) {
+    const auto [d, key, id, v] = OPEN.top();
+    OPEN.pop();
+    if (dist[v->id] != d || task[v->id]->id != id) continue;  // outdated
+    for (auto u : v->neighbor) push(d + 1, {task[v->id], key}, u);
+  }
+}
+
+Task* PickupField::getNearest(Node* const v) const
+{
+  return dist[v->id] == -1 ? nullptr : task[v->id];
+}
+
+int PickupField::getDist(Node* const v) const { return dist[v->id]; }
@@ -1,65 +1,114 @@
 #include "../include/plan.hpp"
 
-Config Plan::get(const int t) const
+Plan::Plan(const Trajectories& _trajectories) : trajectories(_trajectories)
 {
-  const int configs_size = configs.size();
-  if (!(0 <= t && t < configs_size)) halt("invalid timestep");
-  return configs[t];
+  if (trajectories.getLayout() == Trajectories::AGENT_MAJOR) {
+    for (int i = 0; i < trajectories.getNumAgents(); ++i) {
+      if (trajectories.getPathLength(i) == 0) halt("empty path");
+    }
+    trajectories.setLayout(Trajectories::TIME_MAJOR);
+  }
+  const int num_agents = trajectories.getNumAgents();
+  last_move.assign(num_agents, 0);
+  for (int t = 1; t < size(); ++t) {
+    for (int i = 0; i < num_agents; ++i) {
+      if (get(t, i) != get(t - 1, i)) last_move[i] = t;
+    }
+  }
+}
+
+NodesView Plan::get(const int t) const
+{
+  if (!(0 <= t && t < size())) halt("invalid timestep");
+  if (t < dropped) halt("not stored, t=" + std::to_string(t));
+  return trajectories.getConfig(t - dropped);
 }
 
 Node* Plan::get(const int t, const int i) const
 {
   if (empty()) halt("invalid operation");
-  if (!(0 <= t && t < (int)configs.size())) halt("invalid timestep");
-  if (!(0 <= i && i < (int)configs[0].size())) halt("invalid agent id");
-  return configs[t][i];
+  if (!(0 <= t && t < size())) halt("invalid timestep");
+  if (!(0 <= i && i < trajectories.getNumAgents())) halt("invalid agent id");
+  if (t < dropped) halt("not stored, t=" + std::to_string(t));
+  return trajectories.get(t - dropped, i);
 }
 
 Path Plan::getPath(const int i) const
 {
-  Path path;
-  int makespan = getMakespan();
-  for (int t = 0; t <= makespan; ++t) path.push_back(get(t, i));
-  return path;
+  if (empty()) return Path();
+  if (!(0 <= i && i < trajectories.getNumAgents())) halt("invalid agent id");
+  if (!isComplete()) halt("not stored, summary mode");
+  return trajectories.getPath(i);
 }
 
-Config Plan::last() const
+NodesView Plan::last() const
 {
   if (empty()) halt("invalid operation");
-  return configs[getMakespan()];
+  return trajectories.getConfig(getMakespan() - dropped);
 }
 
 Node* Plan::last(const int i) const
 {
   if (empty()) halt("invalid operation");
-  if (i < 0 || (int)configs[0].size() <= i) halt("invalid operation");
-  return configs[getMakespan()][i];
+  if (i < 0 || trajectories.getNumAgents() <= i) halt("invalid operation");
+  return trajectories.get(getMakespan() - dropped, i);
+}
+
+void Plan::clear()
+{
+  trajectories = Trajectories();
+  last_move.clear();
+  dropped = 0;
+}
+
+void Plan::setSummaryOnly(const bool flag)
+{
+  summary_only = flag;
+  if (!summary_only || size() <= 1) return;
+  Config c = last();
+  dropped += trajectories.getHorizon() - 1;
+  trajectories.clear();
+  trajectories.addConfig(c);
 }
 
-void Plan::clear() { configs.clear(); }
+void Plan::updateLastMove(const Config& c)
+{
+  if (empty()) {
+    last_move.assign(c.size(), 0);
+    return;
+  }
+  const int t = size();
+  const int num_agents = c.size();
+  for (int i = 0; i < num_agents; ++i) {
+    if (c[i] != last(i)) last_move[i] = t;
+  }
+}
 
 void Plan::add(const Config& c)
 {
-  if (!configs.empty() && configs.at(0).size() != c.size()) {
+  if (!empty() && trajectories.getNumAgents() != (int)c.size()) {
     halt("invalid operation");
   }
-  configs.push_back(c);
+  updateLastMove(c);
+  if (summary_only && !empty()) {
+    ++dropped;
+    trajectories.clear();
+  }
+  trajectories.addConfig(c);
 }
 
-bool Plan::empty() const { return configs.empty(); }
+bool Plan::empty() const { return size() == 0; }
 
-int Plan::size() const { return configs.size(); }
+int Plan::size() const { return dropped + trajectories.getHorizon(); }
 
 int Plan::getMakespan() const { return size() - 1; }
 
-// original path cost definition
+// original path cost definition, i.e., the last timestep when moving
 int Plan::getPathCost(const int i) const
 {
-  const int makespan = getMakespan();
-  const Node* g = get(makespan, i);
-  int c = makespan;
-  while (c > 0 && get(c - 1, i) == g) --c;
-  return c;
+  if (empty()) halt("invalid operation");
+  if (!(0 <= i && i < (int)last_move.size())) halt("invalid agent id");
+  return last_move[i];
 }
 
 // modified path cost
@@ -84,40 +133,46 @@ int Plan::getSOC() const
 {
   int makespan = getMakespan();
   if (makespan <= 0) return 0;
-  int num_agents = get(0).size();
   int soc = 0;
-  for (int i = 0; i < num_agents; ++i) soc += getPathCost(i);
+  for (auto c : last_move) soc += c;
   return soc;
 }
 
 Plan Plan::operator+(const Plan& other) const
 {
-  // check validity
-  Config c1 = last();
-  Config c2 = other.get(0);
-  const int c1_size = c1.size();
-  const int c2_size = c2.size();
-  if (c1_size != c2_size) halt("invalid operation");
-  for (int i = 0; i < c1_size; ++i) {
-    if (c1[i] != c2[i]) halt("invalid operation.");
-  }
-  // merge
-  Plan new_plan;
-  new_plan.configs = configs;
-  for (int t = 1; t < other.size(); ++t) new_plan.add(other.get(t));
+  Plan new_plan = *this;
+  new_plan += other;
   return new_plan;
 }
 
 void Plan::operator+=(const Plan& other)
 {
-  if (configs.empty()) {
-    configs = other.configs;
+  if (empty()) {
+    const bool flag = summary_only;
+    *this = other;
+    setSummaryOnly(flag);
     return;
   }
-  // check validity
-  if (!sameConfig(last(), other.get(0))) halt("invalid operation");
+  // check validity, the first configuration of summary is not stored
+  if (other.summary_only) {
+    if (!summary_only) halt("invalid operation");
+  } else if (!sameConfig(last(), other.get(0))) {
+    halt("invalid operation");
+  }
   // merge
-  for (int t = 1; t < other.size(); ++t) add(other.get(t));
+  const int makespan = getMakespan();
+  const int num_agents = last_move.size();
+  for (int i = 0; i < num_agents; ++i) {
+    if (other.last_move[i] > 0) last_move[i] = makespan + other.last_move[i];
+  }
+  if (summary_only) {
+    Config c = other.last();
+    dropped += other.getMakespan();
+    trajectories.clear();
+    trajectories.addConfig(c);
+  } else {
+    for (int t = 1; t < other.size(); ++t) trajectories.addConfig(other.get(t));
+  }
 }
 
 bool Plan::validate(MAPF_Instance* P) const
@@ -132,7 +187,7 @@ bool Plan::validate(MAPD_Instance* P) const
     warn("validation, tasks remain");
     return false;
   }
-  auto closed_tasks = P->getClosedTasks();
+  auto& closed_tasks = P->getClosedTasks();
   if ((int)closed_tasks.size() != P->getTaskNum()) {
     warn("validation, num of closed_tasks is invalid");
     return false;
@@ -159,7 +214,11 @@ bool Plan::validate(const Config& starts, const Config& goals) const
 
 bool Plan::validate(const Config& starts) const
 {
-  if (configs.empty()) return false;
+  if (empty()) return false;
+  if (!isComplete()) {
+    warn("validation, configurations are not stored");
+    return false;
+  }
 
   // start
   if (!sameConfig(starts, get(0))) {
@@ -167,46 +226,100 @@ bool Plan::validate(const Config& starts) const
     return false;
   }
 
-  // check conflicts and continuity
-  int num_agents = get(0).size();
-  for (int t = 1; t <= getMakespan(); ++t) {
-    if ((int)configs[t].size() != num_agents) {
+  /*
+   * Check conflicts and continuity in O(T * N).
+   * Locations are registered to node-id -> agent tables stamped with the
+   * timestep, two tables are used alternately for t and t-1.
+   * The reported error is the same as the one of the naive pairwise check,
+   * i.e., the first agent (ascending order) that has an invalid move or
+   * conflicts with someone, and its conflicting agent with the smallest id.
+   */
+  const int num_agents = get(0).size();
+  const int makespan = getMakespan();
+  int max_node_id = 0;
+  for (int t = 0; t <= makespan; ++t) {
+    for (auto v : get(t)) max_node_id = std::max(max_node_id, v->id);
+  }
+  std::vector<std::vector<int>> stamp(2, std::vector<int>(max_node_id + 1, -1));
+  std::vector<std::vector<int>> owner(2, std::vector<int>(max_node_id + 1, -1));
+  auto registerConfig = [&](const int t) {
+    for (int i = 0; i < num_agents; ++i) {
+      const int v_id = get(t, i)->id;
+      if (stamp[t & 1][v_id] == t) continue;  // keep the first agent
+      stamp[t & 1][v_id] = t;
+      owner[t & 1][v_id] = i;
+    }
+  };
+  registerConfig(0);
+
+  enum ConflictType { NONE, VERTEX, SWAP };
+  std::vector<int> partner(num_agents);
+  std::vector<ConflictType> conflict(num_agents);
+  auto setConflict = [&](const int i, const int j, const ConflictType type) {
+    const int a = std::min(i, j);
+    const int b = std::max(i, j);
+    if (conflict[a] == NONE || b < partner[a]) {
+      conflict[a] = type;
+      partner[a] = b;
+    }
+  };
+
+  for (int t = 1; t <= makespan; ++t) {
+    const auto c_t = get(t);
+    const auto c_t_1 = get(t - 1);
+    if ((int)c_t.size() != num_agents) {
       warn("validation, invalid size");
       return false;
     }
+    std::fill(conflict.begin(), conflict.end(), NONE);
+
+    // vertex conflicts
     for (int i = 0; i < num_agents; ++i) {
-      Node* v_i_t = get(t, i);
-      Node* v_i_t_1 = get(t - 1, i);
-      Nodes cands = v_i_t_1->neighbor;
-      cands.push_back(v_i_t_1);
-      if (!inArray(v_i_t, cands)) {
+      const int v_id = c_t[i]->id;
+      if (stamp[t & 1][v_id] == t) {
+        setConflict(owner[t & 1][v_id], i, VERTEX);
+      } else {
+        stamp[t & 1][v_id] = t;
+        owner[t & 1][v_id] = i;
+      }
+    }
+
+    // swap conflicts
+    for (int i = 0; i < num_agents; ++i) {
+      Node* v_i_t = c_t[i];
+      Node* v_i_t_1 = c_t_1[i];
+      if (v_i_t == v_i_t_1) continue;  // covered by vertex conflicts
+      if (stamp[(t - 1) & 1][v_i_t->id] != t - 1) continue;
+      const int j = owner[(t - 1) & 1][v_i_t->id];
+      if (j != i && c_t[j] == v_i_t_1) setConflict(i, j, SWAP);
+    }
+
+    // report the first error
+    for (int i = 0; i < num_agents; ++i) {
+      Node* v_i_t = c_t[i];
+      Node* v_i_t_1 = c_t_1[i];
+      if (v_i_t != v_i_t_1 && !inArray(v_i_t, v_i_t_1->neighbor)) {
         warn("validation, invalid move at t=" + std::to_string(t));
         return false;
       }
-      // see conflicts
-      for (int j = i + 1; j < num_agents; ++j) {
-        Node* v_j_t = get(t, j);
-        Node* v_j_t_1 = get(t - 1, j);
-        if (v_i_t == v_j_t) {
-          warn("validation, vertex conflict at v=" + std::to_string(v_i_t->id) +
-               ", t=" + std::to_string(t));
-          return false;
-        }
-        if (v_i_t == v_j_t_1 && v_i_t_1 == v_j_t) {
-          warn("validation, swap conflict");
-          return false;
-        }
+      if (conflict[i] == VERTEX) {
+        warn("validation, vertex conflict at v=" + std::to_string(v_i_t->id) +
+             ", t=" + std::to_string(t));
+        return false;
+      }
+      if (conflict[i] == SWAP) {
+        warn("validation, swap conflict");
+        return false;
       }
     }
   }
   return true;
 }
 
-int Plan::getMaxConstraintTime(const int id, Node* s, Node* g, Graph* G) const
+int Plan::getMaxConstraintTime(const int id, Node* g, const int dist) const
 {
   const int makespan = getMakespan();
-  const int dist = G->pathDist(s, g);
-  const int num = configs[0].size();
+  const int num = trajectories.getNumAgents();
   for (int t = makespan - 1; t >= dist; --t) {
     for (int i = 0; i < num; ++i) {
       if (i != id && get(t, i) == g) return t;
@@ -215,16 +328,20 @@ int Plan::getMaxConstraintTime(const int id, Node* s, Node* g, Graph* G) const
   return 0;
 }
 
+int Plan::getMaxConstraintTime(const int id, Node* s, Node* g, Graph* G) const
+{
+  return getMaxConstraintTime(id, g, G->pathDist(s, g));
+}
+
 int Plan::getMaxConstraintTime(const int id, MAPF_Instance* P) const
 {
-  return getMaxConstraintTime(id, P->getStart(id), P->getGoal(id), P->getG());
+  Node* g = P->getGoal(id);
+  return getMaxConstraintTime(id, g, P->getPathDist(P->getStart(id), g));
 }
 
 void Plan::halt(const std::string& msg) const
 {
-  std::cout << "error@Plan: " << msg << std::endl;
-  this->~Plan();
-  std::exit(1);
+  throw std::runtime_error("error@Plan: " + msg);
 }
 
 void Plan::warn(const std::string& msg) const
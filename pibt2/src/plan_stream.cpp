@@ -0,0 +1,353 @@
+#include "../include/plan_stream.hpp"
+
+#include <iostream>
+
+// -----------------------------------------------
+// writer
+// -----------------------------------------------
+
+BinaryPlanWriter::BinaryPlanWriter(const std::string& filename)
+    : fp(std::fopen(filename.c_str(), "wb")), written(0)
+{
+  if (fp == nullptr) halt("cannot open " + filename);
+  buf.reserve(BUFFER_SIZE);
+}
+
+BinaryPlanWriter::~BinaryPlanWriter()
+{
+  if (fp == nullptr) return;
+  // must not throw here, errors after end() are only reported
+  const bool ok = writeBuffer();
+  if (std::fclose(fp) != 0 || !ok) {
+    std::cout << "error@BinaryPlanWriter: failed to write" << std::endl;
+  }
+  fp = nullptr;
+}
+
+void BinaryPlanWriter::putVarint(uint64_t x)
+{
+  while (x >= 0x80) {
+    buf.push_back((uint8_t)(x | 0x80));
+    x >>= 7;
+  }
+  buf.push_back((uint8_t)x);
+}
+
+void BinaryPlanWriter::putSigned(int64_t x)
+{
+  putVarint(((uint64_t)x << 1) ^ (uint64_t)(x >> 63));  // zigzag
+}
+
+void BinaryPlanWriter::putString(const std::string& str)
+{
+  putVarint(str.size());
+  buf.insert(buf.end(), str.begin(), str.end());
+}
+
+bool BinaryPlanWriter::writeBuffer()
+{
+  if (buf.empty()) return true;
+  const bool ok = std::fwrite(buf.data(), 1, buf.size(), fp) == buf.size();
+  written += buf.size();
+  buf.clear();
+  return ok;
+}
+
+void BinaryPlanWriter::flush()
+{
+  if (!writeBuffer()) halt("failed to write");
+}
+
+void BinaryPlanWriter::begin(const std::string& map_file, const int width,
+                             const int height, const Config& starts,
+                             const Config& goals, const bool with_targets)
+{
+  buf.insert(buf.end(), PlanFormat::MAGIC.begin(), PlanFormat::MAGIC.end());
+  putVarint(PlanFormat::VERSION);
+  putString(map_file);
+  putVarint(width);
+  putVarint(height);
+  putVarint(starts.size());
+  for (auto v : starts) putVarint(v->id);
+  putVarint(goals.size());
+  for (auto v : goals) putVarint(v->id);
+  putVarint(with_targets);
+
+  prev_config.resize(starts.size());
+  for (int i = 0; i < (int)starts.size(); ++i) prev_config[i] = starts[i]->id;
+  prev_targets = prev_config;
+  prev_tasks.assign(starts.size(), Task::NIL);
+}
+
+void BinaryPlanWriter::config(const NodesView& c)
+{
+  const int num_agents = prev_config.size();
+  if (c.size() != num_agents) halt("invalid configuration size");
+  int num_moved = 0;
+  for (int i = 0; i < num_agents; ++i) {
+    if (c[i]->id != (int)prev_config[i]) ++num_moved;
+  }
+  buf.push_back(PlanFormat::CONFIG);
+  putVarint(num_moved);
+  int prev_i = 0;
+  for (int i = 0; i < num_agents; ++i) {
+    const uint32_t v_id = c[i]->id;
+    if (v_id == prev_config[i]) continue;
+    putVarint(i - prev_i);
+    putSigned((int64_t)v_id - prev_config[i]);
+    prev_config[i] = v_id;
+    prev_i = i;
+  }
+  if (buf.size() >= BUFFER_SIZE) flush();
+}
+
+void BinaryPlanWriter::targetEvent(const TargetEvent& e)
+{
+  const int i = e.agent;
+  if (i < 0 || i >= (int)prev_targets.size()) halt("invalid agent id");
+  const uint32_t v_id = e.target->id;
+  buf.push_back(PlanFormat::TARGET);
+  putVarint(e.timestep);
+  putVarint(i);
+  putSigned((int64_t)v_id - prev_targets[i]);
+  putSigned((int64_t)e.task_id - prev_tasks[i]);
+  prev_targets[i] = v_id;
+  prev_tasks[i] = e.task_id;
+  if (buf.size() >= BUFFER_SIZE) flush();
+}
+
+void BinaryPlanWriter::taskEvent(const TaskEvent& e)
+{
+  buf.push_back(PlanFormat::TASK);
+  putVarint(e.type);
+  putVarint(e.task_id);
+  putVarint(e.agent);
+  putVarint(e.timestep);
+  if (buf.size() >= BUFFER_SIZE) flush();
+}
+
+void BinaryPlanWriter::end(const std::string& info, const std::string& tasks)
+{
+  const uint64_t offset = written + buf.size();
+  buf.push_back(PlanFormat::END);
+  putString(info);
+  putString(tasks);
+  for (int k = 0; k < 8; ++k) buf.push_back((uint8_t)(offset >> (8 * k)));
+  flush();
+  if (std::fflush(fp) != 0) halt("failed to write");
+}
+
+void BinaryPlanWriter::halt(const std::string& msg) const
+{
+  throw std::runtime_error("error@BinaryPlanWriter: " + msg);
+}
+
+// -----------------------------------------------
+// text writer
+// -----------------------------------------------
+
+TextPlanWriter::TextPlanWriter(const std::string& filename)
+    : out(filename), mapd(false), timestep(0)
+{
+}
+
+void TextPlanWriter::writeNode(const Node* v)
+{
+  out.write('(');
+  out.writeInt(v->pos.x);
+  out.write(',');
+  out.writeInt(v->pos.y);
+  out.write(')');
+}
+
+void TextPlanWriter::begin(const std::string& map_file, const int width,
+                           const int height, const Config& starts,
+                           const Config& goals, const bool with_targets)
+{
+  mapd = goals.empty();
+  out.write("map_file=" + map_file + "\n");
+  out.write("agents=");
+  out.writeInt(starts.size());
+  out.write("\nstarts=");
+  for (auto v : starts) {
+    writeNode(v);
+    out.write(',');
+  }
+  if (!mapd) {
+    out.write("\ngoals=");
+    for (auto v : goals) {
+      writeNode(v);
+      out.write(',');
+    }
+  }
+  out.write("\nsolution=\n");
+}
+
+void TextPlanWriter::config(const NodesView& c)
+{
+  out.writeInt(timestep++);
+  out.write(':');
+  for (auto v : c) {
+    writeNode(v);
+    out.write(',');
+  }
+  out.write('\n');
+}
+
+void TextPlanWriter::targetEvent(const TargetEvent& e)
+{
+  out.writeInt(e.timestep);
+  out.write('@');
+  out.writeInt(e.agent);
+  out.write("->", 2);
+  writeNode(e.target);
+  out.write(':');
+  out.writeInt(e.task_id);
+  out.write('\n');
+}
+
+void TextPlanWriter::end(const std::string& info, const std::string& tasks)
+{
+  if (mapd) {
+    out.write("task=\n");
+    out.write(tasks);
+  }
+  out.write(info);
+  if (!out.close()) out.halt("failed to write");
+}
+
+// -----------------------------------------------
+// reader
+// -----------------------------------------------
+
+BinaryPlanReader::BinaryPlanReader(const std::string& filename)
+    : fp(std::fopen(filename.c_str(), "rb"), std::fclose),
+      buf(BUFFER_SIZE),
+      pos(0),
+      filled(0),
+      width(0),
+      height(0),
+      with_targets(false),
+      target_event{0, 0, nullptr, Task::NIL},
+      task_event{TaskEvent::ASSIGNED, Task::NIL, 0, 0}
+{
+  if (fp == nullptr) halt("cannot open " + filename);
+
+  // footer
+  uint8_t trailer[8];
+  if (std::fseek(fp.get(), -8, SEEK_END) != 0 ||
+      std::fread(trailer, 1, 8, fp.get()) != 8) {
+    halt("unfinished file, " + filename);
+  }
+  uint64_t offset = 0;
+  for (int k = 0; k < 8; ++k) offset |= (uint64_t)trailer[k] << (8 * k);
+  seek(offset);
+  if (getByte() != PlanFormat::END) halt("broken footer");
+  info = getString();
+  tasks_info = getString();
+
+  // header
+  seek(0);
+  for (auto c : PlanFormat::MAGIC) {
+    if (getByte() != (uint8_t)c) halt("not a plan file, " + filename);
+  }
+  if (getVarint() != PlanFormat::VERSION) halt("unsupported version");
+  map_file = getString();
+  width = getVarint();
+  height = getVarint();
+  starts.resize(getVarint());
+  for (auto& v : starts) v = getVarint();
+  goals.resize(getVarint());
+  for (auto& v : goals) v = getVarint();
+  with_targets = getVarint() != 0;
+
+  config = starts;
+  targets = starts;
+  tasks.assign(starts.size(), Task::NIL);
+}
+
+void BinaryPlanReader::seek(long offset)
+{
+  if (std::fseek(fp.get(), offset, SEEK_SET) != 0) halt("failed to seek");
+  pos = 0;
+  filled = 0;
+}
+
+uint8_t BinaryPlanReader::getByte()
+{
+  if (pos == filled) {
+    filled = std::fread(buf.data(), 1, buf.size(), fp.get());
+    pos = 0;
+    if (filled == 0) halt("unexpected end of file");
+  }
+  return buf[pos++];
+}
+
+uint64_t BinaryPlanReader::getVarint()
+{
+  uint64_t x = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    const uint8_t b = getByte();
+    x |= (uint64_t)(b & 0x7f) << shift;
+    if (!(b & 0x80)) return x;
+  }
+  halt("broken varint");
+  return x;
+}
+
+int64_t BinaryPlanReader::getSigned()
+{
+  const uint64_t x = getVarint();
+  return (int64_t)(x >> 1) ^ -(int64_t)(x & 1);
+}
+
+std::string BinaryPlanReader::getString()
+{
+  const uint64_t len = getVarint();
+  std::string str(len, '\0');
+  for (auto& c : str) c = getByte();
+  return str;
+}
+
+PlanFormat::Record BinaryPlanReader::next()
+{
+  const uint8_t record = getByte();
+  const int num_agents = starts.size();
+  int i = 0;
+  switch (record) {
+    case PlanFormat::CONFIG:
+      for (uint64_t k = getVarint(); k > 0; --k) {
+        i += getVarint();
+        if (i >= num_agents) halt("invalid agent id");
+        config[i] += getSigned();
+      }
+      break;
+    case PlanFormat::TARGET:
+      target_event.timestep = getVarint();
+      i = getVarint();
+      if (i < 0 || i >= num_agents) halt("invalid agent id");
+      targets[i] += getSigned();
+      tasks[i] += getSigned();
+      target_event.agent = i;
+      target_event.task_id = tasks[i];
+      break;
+    case PlanFormat::TASK:
+      task_event.type = (TaskEvent::Type)getVarint();
+      if (task_event.type > TaskEvent::DELIVERED) halt("unknown task event");
+      task_event.task_id = getVarint();
+      task_event.agent = getVarint();
+      if (task_event.agent >= num_agents) halt("invalid agent id");
+      task_event.timestep = getVarint();
+      break;
+    case PlanFormat::END:
+      break;
+    default:
+      halt("unknown record");
+  }
+  return (PlanFormat::Record)record;
+}
+
+void BinaryPlanReader::halt(const std::string& msg) const
+{
+  throw std::runtime_error("error@BinaryPlanReader: " + msg);
+}
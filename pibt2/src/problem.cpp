@@ -1,8 +1,12 @@
 #include "../include/problem.hpp"
 
+#include <algorithm>
 #include <fstream>
-#include <regex>
+#include <iterator>
+#include <mutex>
+#include <unordered_map>
 
+#include "../include/text_parser.hpp"
 #include "../include/util.hpp"
 
 Problem::Problem(std::string _instance, Graph* _G, std::mt19937* _MT,
@@ -29,11 +33,93 @@ Node* Problem::getGoal(int i) const
   return config_g[i];
 }
 
+// -------------------------------------------
+// caches
+
+static std::mutex cache_mtx;
+static std::unordered_map<std::string, std::weak_ptr<Problem::Map>> map_cache;
+static std::unordered_map<std::string,
+                          std::weak_ptr<const Problem::Scenario>>
+    scenario_cache;
+
+// entry of the cache alive, or the one created by fn
+// fn runs without the lock, the first one published wins when threads race
+template <typename T, typename F>
+static std::shared_ptr<T> lookup(
+    std::unordered_map<std::string, std::weak_ptr<T>>& cache,
+    const std::string& key, F fn)
+{
+  {
+    std::lock_guard<std::mutex> lk(cache_mtx);
+    auto itr = cache.find(key);
+    if (itr != cache.end()) {
+      if (auto entry = itr->second.lock()) return entry;
+    }
+  }
+  std::shared_ptr<T> created = fn();
+  std::lock_guard<std::mutex> lk(cache_mtx);
+  auto& entry = cache[key];
+  if (auto other = entry.lock()) return other;
+  entry = created;
+  // drop entries of freed files
+  for (auto itr = cache.begin(); itr != cache.end();) {
+    itr = itr->second.expired() ? cache.erase(itr) : std::next(itr);
+  }
+  return created;
+}
+
+std::shared_ptr<Problem::Map> Problem::loadMap(const std::string& map_file)
+{
+  return lookup(map_cache, map_file,
+                [&] { return std::make_shared<Map>(map_file); });
+}
+
+std::shared_ptr<const Problem::Scenario> Problem::loadScenario(
+    const std::string& scen_file)
+{
+  return lookup(scenario_cache, scen_file, [&] {
+    // a missing file gives no starts/goals
+    auto rows = std::make_shared<Scenario>();
+    std::string buf;
+    if (TextParser::readFile(scen_file, buf)) {
+      TextParser::LineReader reader(buf);
+      std::string_view line;
+      ScenarioRow row;
+      while (reader.next(line)) {
+        if (TextParser::parseScenLine(line, row.x_s, row.y_s, row.x_g,
+                                      row.y_g)) {
+          rows->push_back(row);
+        }
+      }
+    }
+    return std::shared_ptr<const Scenario>(rows);
+  });
+}
+
+// G given by caller is not shared, no lock
+int Problem::getPathDist(Node* const s, Node* const g) const
+{
+  if (map == nullptr) return G->pathDist(s, g);
+  std::lock_guard<std::mutex> lk(map->mtx);
+  return G->pathDist(s, g);
+}
+
+Path Problem::getCachedPath(Node* const s, Node* const g) const
+{
+  if (map == nullptr) return G->getPath(s, g, true);
+  std::lock_guard<std::mutex> lk(map->mtx);
+  return G->getPath(s, g, true);
+}
+
 void Problem::halt(const std::string& msg) const
 {
-  std::cout << "error@Problem: " << msg << std::endl;
-  this->~Problem();
-  std::exit(1);
+  throw std::runtime_error("error@Problem: " + msg);
+}
+
+void Problem::createMT(const int seed)
+{
+  MT_owned = std::make_unique<std::mt19937>(seed);
+  MT = MT_owned.get();
 }
 
 void Problem::warn(const std::string& msg) const
@@ -49,49 +135,41 @@ MAPF_Instance::MAPF_Instance(const std::string& _instance, const std::string& sc
     : Problem(_instance), instance_initialized(true)
 {
   // read instance file
-  std::ifstream file(instance);
-  if (!file) halt("file " + instance + " is not found.");
-
-  std::string line;
-  std::smatch results;
-  std::regex r_comment = std::regex(R"(#.+)");
-  std::regex r_map = std::regex(R"(map_file=(.+))");
-  std::regex r_agents = std::regex(R"(agents=(\d+))");
-  std::regex r_seed = std::regex(R"(seed=(\d+))");
-  std::regex r_random_problem = std::regex(R"(random_problem=(\d+))");
-  std::regex r_well_formed = std::regex(R"(well_formed=(\d+))");
-  std::regex r_max_timestep = std::regex(R"(max_timestep=(\d+))");
-  std::regex r_max_comp_time = std::regex(R"(max_comp_time=(\d+))");
-  std::regex r_sg = std::regex(R"(\d+\t.+\.map\t\d+\t\d+\t(\d+)\t(\d+)\t(\d+)\t(\d+)\t.+)");
+  std::string buf;
+  if (!TextParser::readFile(instance, buf)) {
+    halt("file " + instance + " is not found.");
+  }
 
+  std::string_view line, value;
+  int x;
   bool read_scen = true;
   bool well_formed = false;
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
+  TextParser::LineReader reader(buf);
+  while (reader.next(line)) {
     // comment
-    if (std::regex_match(line, results, r_comment)) {
+    if (TextParser::isComment(line)) {
       continue;
     }
     // read map
-    if (std::regex_match(line, results, r_map)) {
-      G = new Grid(results[1].str());
+    if (TextParser::matchKey(line, "map_file", value)) {
+      map = loadMap(std::string(value));
+      G = &map->G;
       continue;
     }
     // set agent num
-    if (std::regex_match(line, results, r_agents)) {
-      num_agents = std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "agents", x)) {
+      num_agents = x;
       continue;
     }
     num_agents = num_of_agents;
     // set random seed
-    if (std::regex_match(line, results, r_seed)) {
-      MT = new std::mt19937(std::stoi(results[1].str()));
+    if (TextParser::matchKey(line, "seed", x)) {
+      createMT(x);
       continue;
     }
     // skip reading initial/goal nodes
-    if (std::regex_match(line, results, r_random_problem)) {
-      if (std::stoi(results[1].str())) {
+    if (TextParser::matchKey(line, "random_problem", x)) {
+      if (x) {
         read_scen = false;
         config_s.clear();
         config_g.clear();
@@ -99,58 +177,45 @@ MAPF_Instance::MAPF_Instance(const std::string& _instance, const std::string& sc
       continue;
     }
     //
-    if (std::regex_match(line, results, r_well_formed)) {
-      if (std::stoi(results[1].str())) well_formed = true;
+    if (TextParser::matchKey(line, "well_formed", x)) {
+      if (x) well_formed = true;
       continue;
     }
     // set max timestep
-    if (std::regex_match(line, results, r_max_timestep)) {
-      max_timestep = std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "max_timestep", x)) {
+      max_timestep = x;
       continue;
     }
     // set max computation time
-    if (std::regex_match(line, results, r_max_comp_time)) {
-      max_comp_time = std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "max_comp_time", x)) {
+      max_comp_time = x;
       continue;
     }
-
   }
 
-
-
   // get scenario
-  std::ifstream file_1(scen_filename);
-  std::string line_1;
-  std::smatch results_1;
-
-  while (getline(file_1, line_1)) {
+  auto scen = loadScenario(scen_filename);
+  for (auto& row : *scen) {
+    if (!read_scen || (int)config_s.size() >= num_agents) break;
     // read initial/goal nodes
-    if (std::regex_match(line_1, results_1, r_sg) && read_scen &&
-        (int)config_s.size() < num_agents) {
-      int x_s = std::stoi(results_1[1].str());
-      int y_s = std::stoi(results_1[2].str());
-      int x_g = std::stoi(results_1[3].str());
-      int y_g = std::stoi(results_1[4].str());
-      if (!G->existNode(x_s, y_s)) {
-        halt("start node (" + std::to_string(x_s) + ", " + std::to_string(y_s) +
-             ") does not exist, invalid scenario");
-      }
-      if (!G->existNode(x_g, y_g)) {
-        halt("goal node (" + std::to_string(x_g) + ", " + std::to_string(y_g) +
-             ") does not exist, invalid scenario");
-      }
-
-      Node* s = G->getNode(x_s, y_s);
-      Node* g = G->getNode(x_g, y_g);
-      config_s.push_back(s);
-      config_g.push_back(g);
+    const int x_s = row.x_s, y_s = row.y_s, x_g = row.x_g, y_g = row.y_g;
+    if (!G->existNode(x_s, y_s)) {
+      halt("start node (" + std::to_string(x_s) + ", " + std::to_string(y_s) +
+           ") does not exist, invalid scenario");
+    }
+    if (!G->existNode(x_g, y_g)) {
+      halt("goal node (" + std::to_string(x_g) + ", " + std::to_string(y_g) +
+           ") does not exist, invalid scenario");
     }
-  }
-
 
+    Node* s = G->getNode(x_s, y_s);
+    Node* g = G->getNode(x_g, y_g);
+    config_s.push_back(s);
+    config_g.push_back(g);
+  }
 
   // set default value not identified params
-  if (MT == nullptr) MT = new std::mt19937(DEFAULT_SEED);
+  if (MT == nullptr) createMT(DEFAULT_SEED);
   if (max_timestep == 0) max_timestep = DEFAULT_MAX_TIMESTEP;
   if (max_comp_time == 0) max_comp_time = DEFAULT_MAX_COMP_TIME;
 
@@ -182,6 +247,7 @@ MAPF_Instance::MAPF_Instance(MAPF_Instance* P, Config _config_s,
               _config_g, P->getNum(), _max_timestep, _max_comp_time),
       instance_initialized(false)
 {
+  map = P->map;
 }
 
 MAPF_Instance::MAPF_Instance(MAPF_Instance* P, int _max_comp_time)
@@ -190,15 +256,10 @@ MAPF_Instance::MAPF_Instance(MAPF_Instance* P, int _max_comp_time)
               P->getMaxTimestep(), _max_comp_time),
       instance_initialized(false)
 {
+  map = P->map;
 }
 
-MAPF_Instance::~MAPF_Instance()
-{
-  if (instance_initialized) {
-    if (G != nullptr) delete G;
-    if (MT != nullptr) delete MT;
-  }
-}
+MAPF_Instance::~MAPF_Instance() {}
 
 void MAPF_Instance::setRandomStartsGoals()
 {
@@ -316,87 +377,75 @@ MAPD_Instance::MAPD_Instance(const std::string& _instance)
     : Problem(_instance), current_timestep(-1), specify_pickup_deliv_locs(true)
 {
   // read instance file
-  std::ifstream file(instance);
-  if (!file) halt("file " + instance + " is not found.");
-
-  std::string line;
-  std::smatch results;
-  std::regex r_comment = std::regex(R"(#.+)");
-  std::regex r_map = std::regex(R"(map_file=(.+))");
-  std::regex r_agents = std::regex(R"(agents=(\d+))");
-  std::regex r_seed = std::regex(R"(seed=(\d+))");
-  std::regex r_max_timestep = std::regex(R"(max_timestep=(\d+))");
-  std::regex r_max_comp_time = std::regex(R"(max_comp_time=(\d+))");
-  std::regex r_task_num = std::regex(R"(task_num=(\d+))");
-  std::regex r_task_frequency = std::regex(R"(task_frequency=(.+))");
-  std::regex r_specify_pikup_deliv_locs =
-      std::regex(R"(specify_pikup_deliv_locs=(\d+))");
-  std::regex r_sg = std::regex(R"((\d+),(\d+))");
-
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
+  std::string buf;
+  if (!TextParser::readFile(instance, buf)) {
+    halt("file " + instance + " is not found.");
+  }
+
+  std::string_view line, value;
+  int x, y;
+  TextParser::LineReader reader(buf);
+  while (reader.next(line)) {
     // comment
-    if (std::regex_match(line, results, r_comment)) {
+    if (TextParser::isComment(line)) {
       continue;
     }
     // read map
-    if (std::regex_match(line, results, r_map)) {
-      G = new Grid(results[1].str());
+    if (TextParser::matchKey(line, "map_file", value)) {
+      map = loadMap(std::string(value));
+      G = &map->G;
       continue;
     }
     // set agent num
-    if (std::regex_match(line, results, r_agents)) {
-      num_agents = std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "agents", x)) {
+      num_agents = x;
       continue;
     }
     // set random seed
-    if (std::regex_match(line, results, r_seed)) {
-      MT = new std::mt19937(std::stoi(results[1].str()));
+    if (TextParser::matchKey(line, "seed", x)) {
+      createMT(x);
       continue;
     }
     // set max timestep
-    if (std::regex_match(line, results, r_max_timestep)) {
-      max_timestep = std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "max_timestep", x)) {
+      max_timestep = x;
       continue;
     }
     // set max computation time
-    if (std::regex_match(line, results, r_max_comp_time)) {
-      max_comp_time = std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "max_comp_time", x)) {
+      max_comp_time = x;
       continue;
     }
     // set the number of tasks
-    if (std::regex_match(line, results, r_task_num)) {
-      task_num = std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "task_num", x)) {
+      task_num = x;
       continue;
     }
     // set task frequency
-    if (std::regex_match(line, results, r_task_frequency)) {
-      task_frequency = std::stof(results[1].str());
+    if (TextParser::matchKey(line, "task_frequency", value)) {
+      task_frequency = std::stof(std::string(value));
       continue;
     }
     // set task frequency
-    if (std::regex_match(line, results, r_specify_pikup_deliv_locs)) {
-      specify_pickup_deliv_locs = (bool)std::stoi(results[1].str());
+    if (TextParser::matchKey(line, "specify_pikup_deliv_locs", x)) {
+      specify_pickup_deliv_locs = (bool)x;
       continue;
     }
     // read initial nodes
-    if (std::regex_match(line, results, r_sg) &&
+    if (TextParser::parsePos(line, x, y) &&
         (int)config_s.size() < num_agents) {
-      int x_s = std::stoi(results[1].str());
-      int y_s = std::stoi(results[2].str());
-      if (!G->existNode(x_s, y_s)) {
-        halt("start node (" + std::to_string(x_s) + ", " + std::to_string(y_s) +
+      if (!G->existNode(x, y)) {
+        halt("start node (" + std::to_string(x) + ", " + std::to_string(y) +
              ") does not exist, invalid scenario");
       }
 
-      Node* s = G->getNode(x_s, y_s);
+      Node* s = G->getNode(x, y);
       config_s.push_back(s);
     }
   }
 
   // set default value not identified params
-  if (MT == nullptr) MT = new std::mt19937(DEFAULT_SEED);
+  if (MT == nullptr) createMT(DEFAULT_SEED);
   if (max_timestep == 0) max_timestep = DEFAULT_MAX_TIMESTEP;
   if (max_comp_time == 0) max_comp_time = DEFAULT_MAX_COMP_TIME;
   if (task_frequency == 0) task_frequency = DEFAULT_TASK_FREQUENCY;
@@ -442,58 +491,50 @@ MAPD_Instance::MAPD_Instance(const std::string& _instance)
   config_s.resize(num_agents);
 
   // initialize
+  TASKS.reserve(task_num);
   update();
 }
 
-MAPD_Instance::~MAPD_Instance()
-{
-  for (auto task : TASKS_OPEN) delete task;
-  for (auto task : TASKS_CLOSED) delete task;
-}
+MAPD_Instance::~MAPD_Instance() {}
 
 void MAPD_Instance::setupSpetialNodes()
 {
   Grid* grid = reinterpret_cast<Grid*>(G);
 
   // read instance file
+  std::string buf;
 #ifdef _MAPDIR_
-  std::ifstream file(_MAPDIR_ + grid->getMapFileName() + ".pd");
+  if (!TextParser::readFile(_MAPDIR_ + grid->getMapFileName() + ".pd", buf)) {
+    return;
+  }
 #else
-  std::ifstream file(grid->getMapFileName() + ".pd");
+  if (!TextParser::readFile(grid->getMapFileName() + ".pd", buf)) return;
 #endif
-  if (!file) return;
 
-  std::string line, s;
-  std::smatch results;
-  std::regex r_obj = std::regex(R"([@T])");
-  std::regex r_pickup = std::regex(R"([psa])");  // pickup loc.
-  std::regex r_deliv = std::regex(R"([dsa])");   // delivery loc.
-  std::regex r_end = std::regex(R"([ea])");      // end loc.
+  std::string_view line;
 
   const int width = grid->getWidth();
 
   int y = 0;
-  while (getline(file, line)) {
-    // for CRLF coding
-    if (*(line.end() - 1) == 0x0d) line.pop_back();
-
+  TextParser::LineReader reader(buf);
+  while (reader.next(line)) {
     if ((int)line.size() != width) halt("pd format is invalid");
 
     for (int x = 0; x < width; ++x) {
       if (!G->existNode(x, y)) continue;
 
       auto v = G->getNode(x, y);
-      s = line[x];
+      const char c = line[x];
       bool flg_endpoints = false;
-      if (std::regex_match(s, results, r_pickup)) {
+      if (c == 'p' || c == 's' || c == 'a') {  // pickup loc.
         LOCS_PICKUP.push_back(v);
         flg_endpoints = true;
       }
-      if (std::regex_match(s, results, r_deliv)) {
+      if (c == 'd' || c == 's' || c == 'a') {  // delivery loc.
         LOCS_DELIVERY.push_back(v);
         flg_endpoints = true;
       }
-      if (std::regex_match(s, results, r_end)) {
+      if (c == 'e' || c == 'a') {  // end loc.
         LOCS_NONTASK_ENDPOINTS.push_back(v);
         flg_endpoints = true;
       }
@@ -507,26 +548,21 @@ void MAPD_Instance::setupSpetialNodes()
 
 void MAPD_Instance::update()
 {
-  // check finished tasks
-  auto itr = TASKS_OPEN.begin();
-  while (itr != TASKS_OPEN.end()) {
-    auto task = *itr;
-
-    // not at delivery location
-    if (task->loc_current != task->loc_delivery) {
-      ++itr;
-      continue;
-    }
-
-    task->timestep_finished = current_timestep + 1;
-    TASKS_CLOSED.push_back(task);
-
-    // remove from OPEN list
-    itr = TASKS_OPEN.erase(itr);
-  }
+  // check finished tasks, remove them from OPEN list in one pass
+  auto itr = std::remove_if(TASKS_OPEN.begin(), TASKS_OPEN.end(),
+                            [&](Task* task) {
+                              // not at delivery location
+                              if (task->loc_current != task->loc_delivery) {
+                                return false;
+                              }
+                              task->timestep_finished = current_timestep + 1;
+                              TASKS_CLOSED.push_back(task);
+                              return true;
+                            });
+  TASKS_OPEN.erase(itr, TASKS_OPEN.end());
 
   // create new tasks
-  int created_task_num = int(TASKS_OPEN.size() + TASKS_CLOSED.size());
+  int created_task_num = getCreatedTaskNum();
   if (created_task_num < task_num) {
     int new_task_num = (int)task_frequency;
     if (task_frequency < 1 && getRandomFloat(0, 1, MT) < task_frequency) {
@@ -539,7 +575,9 @@ void MAPD_Instance::update()
         p = randomChoose(LOCS_PICKUP, MT);
         d = randomChoose(LOCS_DELIVERY, MT);
       } while (p == d);
-      TASKS_OPEN.push_back(new Task(p, d, current_timestep + 1));
+      // within the reserved capacity, pointers to tasks remain valid
+      TASKS.emplace_back(TASKS.size(), p, d, current_timestep + 1);
+      TASKS_OPEN.push_back(&TASKS.back());
     }
   }
 
@@ -43,6 +43,7 @@ void PushAndSwap::run()
          ", makespan:", solution.getMakespan(), ", progress:", j + 1, "/",
          P->getNum());
     while (solution.last(i) != P->getGoal(i)) {
+      if (overCompTime()) return;
       if (!push(solution, i, U, occupied_now)) {
         info("   ", "swap required, timestep=", solution.getMakespan());
         if (!swap(solution, i, U, occupied_now)) {
@@ -153,7 +154,7 @@ bool PushAndSwap::swap(Plan& plan, const int r, Nodes& U,
   {
     const int makespan = tmp_plan.getMakespan();
     for (int t = makespan; t >= 0; --t) {
-      auto c = tmp_plan.get(t);
+      Config c = tmp_plan.get(t);
       auto tmp = c[r];
       c[r] = c[s];
       c[s] = tmp;
@@ -556,9 +557,9 @@ void PushAndSwap::setParams(int argc, char* argv[])
       {"disable-dist-init", no_argument, 0, 'd'},
       {0, 0, 0, 0},
   };
-  optind = 1;  // reset
-  int opt, longindex;
-  while ((opt = getopt_long(argc, argv, "cd", longopts, &longindex)) != -1) {
+  OptionScanner scanner(argc, argv, "cd", longopts);
+  int opt;
+  while ((opt = scanner.next()) != -1) {
     switch (opt) {
       case 'c':
         flg_compress = false;
@@ -0,0 +1,56 @@
+#include "../include/reservation_table.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+ReservationTable::ReservationTable(const int _nodes_num, const int _capacity)
+    : nodes_num(_nodes_num),
+      capacity(std::max(1, _capacity)),
+      t_begin(0),
+      head(0),
+      table(capacity * nodes_num, NIL)
+{
+}
+
+void ReservationTable::set(const int t, const int v_id, const int agent)
+{
+  if (t < t_begin) {
+    throw std::runtime_error("error@ReservationTable: timestep " +
+                             std::to_string(t) + " has been dropped");
+  }
+  if (t >= t_begin + capacity) grow(t);
+  table[index(t) + v_id] = agent;
+}
+
+void ReservationTable::advance(const int t)
+{
+  if (t - t_begin >= capacity) {  // all rows are dropped
+    std::fill(table.begin(), table.end(), NIL);
+    t_begin = t;
+    head = 0;
+    return;
+  }
+  for (; t_begin < t; ++t_begin) {
+    // recycle the row as the last one
+    auto itr = table.begin() + index(t_begin);
+    std::fill(itr, itr + nodes_num, NIL);
+    head = (head + 1) % capacity;
+  }
+}
+
+void ReservationTable::grow(const int t)
+{
+  int new_capacity = capacity;
+  while (t >= t_begin + new_capacity) new_capacity *= 2;
+
+  // unroll the ring from t_begin
+  std::vector<int> new_table(new_capacity * nodes_num, NIL);
+  for (int k = 0; k < capacity; ++k) {
+    auto itr = table.begin() + index(t_begin + k);
+    std::copy(itr, itr + nodes_num, new_table.begin() + k * nodes_num);
+  }
+  table.swap(new_table);
+  capacity = new_capacity;
+  head = 0;
+}
@@ -2,6 +2,7 @@
 
 #include <fstream>
 #include <iomanip>
+#include <sstream>
 
 MinimumSolver::MinimumSolver(Problem* _P)
     : solver_name(""),
@@ -12,7 +13,10 @@ MinimumSolver::MinimumSolver(Problem* _P)
       solved(false),
       comp_time(0),
       verbose(false),
-      log_short(false)
+      log_short(false),
+      summary_only(false),
+      plan_stream(nullptr),
+      streamed(0)
 {
 }
 
@@ -23,9 +27,33 @@ void MinimumSolver::solve()
   end();
 }
 
-void MinimumSolver::start() { t_start = Time::now(); }
+void MinimumSolver::start()
+{
+  t_start = Time::now();
+  deadline = given_deadline.within(max_comp_time);
+  streamed = 0;
+  if (plan_stream != nullptr) beginPlanStream();
+}
+
+void MinimumSolver::end()
+{
+  comp_time = getSolverElapsedTime();
+  if (plan_stream != nullptr) flushPlanStream();
+  if (summary_only) solution.setSummaryOnly(true);
+}
 
-void MinimumSolver::end() { comp_time = getSolverElapsedTime(); }
+void MinimumSolver::appendConfig(const Config& c)
+{
+  solution.add(c);
+  if (plan_stream != nullptr) flushPlanStream();
+}
+
+void MinimumSolver::flushPlanStream()
+{
+  for (; streamed < solution.size(); ++streamed) {
+    plan_stream->config(solution.get(streamed));
+  }
+}
 
 // -------------------------------
 // utilities for time
@@ -38,13 +66,10 @@ int MinimumSolver::getSolverElapsedTime() const
 
 int MinimumSolver::getRemainedTime() const
 {
-  return std::max(0, max_comp_time - getSolverElapsedTime());
+  return deadline.getRemainedTime();
 }
 
-bool MinimumSolver::overCompTime() const
-{
-  return getSolverElapsedTime() >= max_comp_time;
-}
+bool MinimumSolver::overCompTime() const { return deadline.expiredNow(); }
 
 // -------------------------------
 // utilities for debug
@@ -56,9 +81,7 @@ void MinimumSolver::info() const
 
 void MinimumSolver::halt(const std::string& msg) const
 {
-  std::cout << "error@" << solver_name << ": " << msg << std::endl;
-  this->~MinimumSolver();
-  std::exit(1);
+  throw std::runtime_error("error@" + solver_name + ": " + msg);
 }
 
 void MinimumSolver::warn(const std::string& msg) const
@@ -75,9 +98,8 @@ MAPF_Solver::MAPF_Solver(MAPF_Instance* _P)
       P(_P),
       LB_soc(0),
       LB_makespan(0),
-      distance_table(G->getNodesSize(),
-                     std::vector<int>(G->getNodesSize(), max_timestep)),
-      distance_table_p(nullptr)
+      distance_table(nullptr),
+      flex_table(nullptr)
 {
 }
 
@@ -90,7 +112,7 @@ MAPF_Solver::~MAPF_Solver() {}
 void MAPF_Solver::exec()
 {
   // create distance table
-  if (distance_table_p == nullptr) {
+  if (distance_table == nullptr) {
     info("  pre-processing, create distance table by BFS");
 //    createDistanceTable();
     info("  pre-processing, create flexibility table by BFS");
@@ -140,35 +162,16 @@ int MAPF_Solver::getLowerBoundMakespan()
 
 // -------------------------------
 // utilities for solution representation
+// both share the same node-id buffer, only the layout is transposed
 Paths MAPF_Solver::planToPaths(const Plan& plan)
 {
-  int num_agents = plan.get(0).size();
-  Paths paths(num_agents);
-  int makespan = plan.getMakespan();
-  for (int i = 0; i < num_agents; ++i) {
-    Path path;
-    for (int t = 0; t <= makespan; ++t) {
-      path.push_back(plan.get(t, i));
-    }
-    paths.insert(i, path);
-  }
-  return paths;
+  return Paths(plan.getTrajectories());
 }
 
 Plan MAPF_Solver::pathsToPlan(const Paths& paths)
 {
-  Plan plan;
-  if (paths.empty()) return plan;
-  int makespan = paths.getMakespan();
-  int num_agents = paths.size();
-  for (int t = 0; t <= makespan; ++t) {
-    Config c;
-    for (int i = 0; i < num_agents; ++i) {
-      c.push_back(paths.get(i, t));
-    }
-    plan.add(c);
-  }
-  return plan;
+  if (paths.empty()) return Plan();
+  return Plan(paths.getTrajectories());
 }
 
 // -------------------------------
@@ -220,7 +223,7 @@ void MAPF_Solver::makeLog(const std::string& logfile)
   log.close();
 }
 
-void MAPF_Solver::makeLogBasicInfo(std::ofstream& log)
+void MAPF_Solver::makeLogBasicInfo(std::ostream& log)
 {
   Grid* grid = reinterpret_cast<Grid*>(P->getG());
   log << "instance=" << P->getInstanceFileName() << "\n";
@@ -238,7 +241,7 @@ void MAPF_Solver::makeLogBasicInfo(std::ofstream& log)
 
 void MAPF_Solver::makeLogSolution(std::ofstream& log)
 {
-  if (log_short) return;
+  if (log_short || summary_only) return;
   log << "starts=";
   for (int i = 0; i < P->getNum(); ++i) {
     Node* v = P->getStart(i);
@@ -261,21 +264,37 @@ void MAPF_Solver::makeLogSolution(std::ofstream& log)
   }
 }
 
+void MAPF_Solver::beginPlanStream()
+{
+  Grid* grid = reinterpret_cast<Grid*>(P->getG());
+  plan_stream->begin(grid->getMapFileName(), grid->getWidth(),
+                     grid->getHeight(), P->getConfigStart(),
+                     P->getConfigGoal(), false);
+}
+
+void MAPF_Solver::closePlanStream()
+{
+  if (plan_stream == nullptr) return;
+  std::ostringstream info;
+  makeLogBasicInfo(info);
+  plan_stream->end(info.str(), "");
+}
+
 // -------------------------------
 // distance
 // -------------------------------
 int MAPF_Solver::nodeDist(Node* const s, Node* const g) const
 {
-  return distance_table[s->id][g->id];  // s->g_node, g->current_node
+  // s->g_node, g->current_node
+  // not computed, same as an unreached entry
+  if (distance_table == nullptr) return max_timestep;
+  return (*distance_table)[s->id][g->id];
 }
 
 
 int MAPF_Solver::pathDist(const int i, Node* const s) const
 {
-  if (distance_table_p != nullptr) {
-    return distance_table_p->operator[](i)[s->id];
-  }
-  return distance_table[i][s->id];
+  return nodeDist(P->getGoal(i), s);
 }
 
 int MAPF_Solver::pathDist(const int i) const
@@ -287,24 +306,24 @@ void MAPF_Solver::createDistanceTable()
 {
   const int nodes_num = G->getNodesSize();
   auto all_nodes = G->get_all_V();
-
-
+  auto table = std::make_shared<DistanceTable>(
+      nodes_num, std::vector<int>(nodes_num, max_timestep));
+  auto& dist = *table;
 
   for (int i = 0; i < nodes_num; ++i) {
     auto u = all_nodes[i];
     if (u == nullptr) continue;
     for (auto v : u->neighbor) {
-      distance_table[i][v->id] = 1;
+      dist[i][v->id] = 1;
     }
-    distance_table[i][i] = 0;
+    dist[i][i] = 0;
   }
 
   // main loop
   for (int k = 0; k < nodes_num; ++k) {
     for (int i = 0; i < nodes_num; ++i) {
       for (int j = 0; j < nodes_num; ++j) {
-        distance_table[i][j] = std::min(
-            distance_table[i][j], distance_table[i][k] + distance_table[k][j]);
+        dist[i][j] = std::min(dist[i][j], dist[i][k] + dist[k][j]);
       }
     }
   }
@@ -327,6 +346,7 @@ void MAPF_Solver::createDistanceTable()
 //    }
 //  }
 
+  distance_table = table;
 }
 
 
@@ -336,7 +356,7 @@ void MAPF_Solver::createDistanceTable()
 void MAPF_Solver::createFlexTable()
 {
   // create distance table
-  if (distance_table_p == nullptr) {
+  if (distance_table == nullptr) {
     info("  pre-processing, create distance table by BFS");
     createDistanceTable();
     info("  pre-processing, create flexibility table by BFS");
@@ -349,10 +369,9 @@ void MAPF_Solver::createFlexTable()
   int curr_dist = 0;
 
   // initialize flex_table
-  for (int iter = 0; iter < G->getNodesSize(); ++iter)
-  {
-    flex_table.push_back(std::vector<int>(G->getNodesSize(), 0));
-  }
+  auto table = std::make_shared<DistanceTable>(
+      G->getNodesSize(), std::vector<int>(G->getNodesSize(), 0));
+  auto& flex = *table;
 
   // first loop for all goal nodes
   for (const auto curr_gnode : map_node)
@@ -391,13 +410,15 @@ void MAPF_Solver::createFlexTable()
         final_point = final_point + evalFlex(closed_node, curr_gnode);
       }
 
-      flex_table[curr_gnode->id][a_node->id] = final_point;
+      flex[curr_gnode->id][a_node->id] = final_point;
 
       // initialize visited
       std::fill(visited_table.begin(),
                 visited_table.end(), false);
     }
   }
+
+  flex_table = table;
 }
 
 int MAPF_Solver::evalFlex(Node* a_node, Node* g_node) const
@@ -448,10 +469,8 @@ std::string MinimumSolver::AstarNode::getName(Node* _v, int _g)
 Path MinimumSolver::getPathBySpaceTimeAstar(
     Node* const s, Node* const g, AstarHeuristics& fValue,
     CompareAstarNode& compare, CheckAstarFin& checkAstarFin,
-    CheckInvalidAstarNode& checkInvalidAstarNode, const int time_limit)
+    CheckInvalidAstarNode& checkInvalidAstarNode, const Deadline& deadline)
 {
-  auto t_start = Time::now();
-
   AstarNodes GC;  // garbage collection
   auto createNewNode = [&GC](Node* v, int g, int f, AstarNode* p) {
     AstarNode* new_node = new AstarNode(v, g, f, p);
@@ -472,7 +491,7 @@ Path MinimumSolver::getPathBySpaceTimeAstar(
   bool invalid = true;
   while (!OPEN.empty()) {
     // check time limit
-    if (time_limit > 0 && getElapsedTime(t_start) > time_limit) break;
+    if (deadline.expired()) break;
 
     // minimum node
     n = OPEN.top();
@@ -526,7 +545,7 @@ MinimumSolver::CompareAstarNode MinimumSolver::compareAstarNodeBasic =
     };
 
 Path MAPF_Solver::getPrioritizedPath(
-    const int id, const Paths& paths, const int time_limit,
+    const int id, const Paths& paths, const Deadline& deadline,
     const int upper_bound,
     const std::vector<std::tuple<Node*, int>>& constraints,
     CompareAstarNode& compare, const bool manage_path_table)
@@ -600,7 +619,7 @@ Path MAPF_Solver::getPrioritizedPath(
   };
 
   auto p = getPathBySpaceTimeAstar(s, g, fValue, compare, checkAstarFin,
-                                   checkInvalidAstarNode, time_limit);
+                                   checkInvalidAstarNode, deadline);
 
   // clear used path table
   if (manage_path_table) clearPathTable(paths);
@@ -668,10 +687,13 @@ void MAPF_Solver::updatePathTableWithoutClear(const int id, const Path& p,
 MAPD_Solver::MAPD_Solver(MAPD_Instance* _P, bool _use_distance_table)
     : MinimumSolver(_P),
       P(_P),
+      record_history(true),
+      targets_timestep(0),
       use_distance_table(_use_distance_table),
       preprocessing_comp_time(0),
-      distance_table(G->getNodesSize(),
-                     std::vector<int>(G->getNodesSize(), G->getNodesSize()))
+      distance_table(nullptr),
+      distance_cache_budget((std::size_t)DEFAULT_DIST_CACHE_MB << 20),
+      distance_cache(nullptr)
 {
 }
 
@@ -679,55 +701,59 @@ MAPD_Solver::~MAPD_Solver() {}
 
 void MAPD_Solver::solve()
 {
-  // create distance table
-  if (use_distance_table) {
+  // create distance table, unless given
+  if (use_distance_table && distance_table == nullptr) {
     auto t_s = Time::now();
-    info("  pre-processing, create distance table by Floyd-Warshall");
+    info("  pre-processing, create distance table by BFS from targets");
     createDistanceTable();
     preprocessing_comp_time = getElapsedTime(t_s);
     info("  done, elapsed: ", preprocessing_comp_time);
   }
 
+  if (distance_cache_budget > 0 && distance_cache == nullptr) {
+    distance_cache =
+        std::make_unique<DistanceFieldCache>(G, distance_cache_budget);
+  }
+
   start();
   exec();
   end();
+
+  if (distance_cache != nullptr) {
+    info("  distance cache, fields:", distance_cache->getSize(), "/",
+         distance_cache->getCapacity(),
+         ", hit rate:", distance_cache->getHitRate(),
+         ", evictions:", distance_cache->getEvictionCnt());
+  }
 }
 
 void MAPD_Solver::exec() { run(); }
 
 int MAPD_Solver::pathDist(Node* const s, Node* const g) const
 {
-  if (use_distance_table) return distance_table[s->id][g->id];
-  return G->pathDist(s, g);
+  if (distance_table != nullptr) {
+    if (distance_table->isTarget(g)) return distance_table->get(s, g);
+    // undirected graph
+    if (distance_table->isTarget(s)) return distance_table->get(g, s);
+  }
+  if (distance_cache != nullptr) return distance_cache->get(s, g);
+  return P->getPathDist(s, g);
 }
 
 void MAPD_Solver::createDistanceTable()
 {
-  const int nodes_num = G->getNodesSize();
-  for (int i = 0; i < nodes_num; ++i) {
-    auto u = G->getNode(i);
-    if (u == nullptr) continue;
-    for (auto v : u->neighbor) {
-      distance_table[i][v->id] = 1;
-    }
-    distance_table[i][i] = 0;
-  }
-
-  // main loop
-  for (int k = 0; k < nodes_num; ++k) {
-    for (int i = 0; i < nodes_num; ++i) {
-      for (int j = 0; j < nodes_num; ++j) {
-        distance_table[i][j] = std::min(
-            distance_table[i][j], distance_table[i][k] + distance_table[k][j]);
-      }
-    }
+  // locations that solvers ask distances to
+  Nodes targets = P->getPickupLocs();
+  for (auto locs : {&P->getDeliveryLocs(), &P->getEndpoints()}) {
+    targets.insert(targets.end(), locs->begin(), locs->end());
   }
+  distance_table = std::make_shared<DistanceTable>(G, targets);
 }
 
 float MAPD_Solver::getTotalServiceTime()
 {
   if (!solved) return false;
-  auto tasks = P->getClosedTasks();
+  auto& tasks = P->getClosedTasks();
   return std::accumulate(tasks.begin(), tasks.end(), 0, [](float acc, Task* a) {
     return acc + a->timestep_finished - a->timestep_appear;
   });
@@ -758,7 +784,7 @@ void MAPD_Solver::makeLog(const std::string& logfile)
   log.close();
 }
 
-void MAPD_Solver::makeLogBasicInfo(std::ofstream& log)
+void MAPD_Solver::makeLogBasicInfo(std::ostream& log)
 {
   Grid* grid = reinterpret_cast<Grid*>(P->getG());
   log << "instance=" << P->getInstanceFileName() << "\n";
@@ -774,7 +800,7 @@ void MAPD_Solver::makeLogBasicInfo(std::ofstream& log)
 
 void MAPD_Solver::makeLogSolution(std::ofstream& log)
 {
-  if (log_short) return;
+  if (log_short || summary_only) return;
 
   log << "starts=";
   for (int i = 0; i < P->getNum(); ++i) {
@@ -783,24 +809,87 @@ void MAPD_Solver::makeLogSolution(std::ofstream& log)
   }
   log << "\n";
   log << "task=\n";
-  for (auto task : P->getClosedTasks()) {
-    log << task->id << ":" << task->loc_pickup->id << "->"
-        << task->loc_delivery->id << ","
-        << "appear=" << task->timestep_appear << ","
-        << "finished=" << task->timestep_finished << "\n";
-  }
+  makeLogTasks(log);
   log << "solution=\n";
+  // without histories, same as MAPF
+  const bool with_targets = record_history && plan_stream == nullptr;
+  Nodes targets = P->getConfigStart();
+  std::vector<int> tasks(P->getNum(), Task::NIL);
+  auto itr = hist_targets.begin();
   for (int t = 0; t <= solution.getMakespan(); ++t) {
+    for (; itr != hist_targets.end() && itr->timestep == t; ++itr) {
+      targets[itr->agent] = itr->target;
+      tasks[itr->agent] = itr->task_id;
+    }
     log << t << ":";
     auto c = solution.get(t);
     for (int i = 0; i < (int)P->getNum(); ++i) {
       auto v = c[i];
-      auto u = hist_targets[t][i];
-      auto task = hist_tasks[t][i];
-      log << "(" << v->pos.x << "," << v->pos.y << ")->"
-          << "(" << u->pos.x << "," << u->pos.y
-          << "):" << ((task == nullptr) ? Task::NIL : task->id) << ",";
+      log << "(" << v->pos.x << "," << v->pos.y << ")";
+      if (with_targets) {
+        auto u = targets[i];
+        log << "->(" << u->pos.x << "," << u->pos.y << "):" << tasks[i];
+      }
+      log << ",";
     }
     log << "\n";
   }
 }
+
+void MAPD_Solver::makeLogTasks(std::ostream& log)
+{
+  for (auto task : P->getClosedTasks()) {
+    log << task->id << ":" << task->loc_pickup->id << "->"
+        << task->loc_delivery->id << ","
+        << "appear=" << task->timestep_appear << ","
+        << "finished=" << task->timestep_finished << "\n";
+  }
+}
+
+void MAPD_Solver::appendTargets(const Nodes& targets, const Tasks& tasks)
+{
+  if (!record_history) return;
+  if (last_targets.empty()) {
+    last_targets = P->getConfigStart();
+    last_tasks.assign(P->getNum(), Task::NIL);
+  }
+
+  // only changes are kept or streamed
+  for (int i = 0; i < (int)P->getNum(); ++i) {
+    const int task_id = (tasks[i] == nullptr) ? Task::NIL : tasks[i]->id;
+    if (targets[i] == last_targets[i] && task_id == last_tasks[i]) continue;
+    last_targets[i] = targets[i];
+    last_tasks[i] = task_id;
+    const TargetEvent e = {targets_timestep, i, targets[i], task_id};
+    if (plan_stream != nullptr) {
+      plan_stream->targetEvent(e);
+    } else if (!summary_only) {
+      hist_targets.push_back(e);
+    }
+  }
+  ++targets_timestep;
+}
+
+void MAPD_Solver::appendTaskEvent(const TaskEvent::Type type, const Task* task,
+                                  const int agent, const int t)
+{
+  if (plan_stream == nullptr || !record_history) return;
+  plan_stream->taskEvent({type, task->id, agent, t});
+}
+
+void MAPD_Solver::beginPlanStream()
+{
+  Grid* grid = reinterpret_cast<Grid*>(P->getG());
+  plan_stream->begin(grid->getMapFileName(), grid->getWidth(),
+                     grid->getHeight(), P->getConfigStart(), {},
+                     record_history);
+}
+
+void MAPD_Solver::closePlanStream()
+{
+  if (plan_stream == nullptr) return;
+  std::ostringstream info, tasks;
+  makeLogBasicInfo(info);
+  makeLogTasks(tasks);
+  plan_stream->end(info.str(), tasks.str());
+}
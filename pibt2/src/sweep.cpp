@@ -0,0 +1,327 @@
+#include "../include/sweep.hpp"
+
+#include <glob.h>
+
+#include <iomanip>
+#include <tuple>
+
+#include "../include/text_parser.hpp"
+#include "../include/thread_pool.hpp"
+
+// -----------------------------------------------
+// config
+// -----------------------------------------------
+
+void SweepConfig::load(const std::string& filename)
+{
+  std::string buf;
+  if (!TextParser::readFile(filename, buf)) {
+    halt("file " + filename + " is not found.");
+  }
+
+  std::string_view line, value;
+  TextParser::LineReader reader(buf);
+  while (reader.next(line)) {
+    if (line.empty() || line[0] == '#') continue;
+    if (TextParser::matchKey(line, "instance", value)) {
+      addInstance(std::string(value));
+    } else if (TextParser::matchKey(line, "scenario", value)) {
+      addScenario(std::string(value));
+    } else if (TextParser::matchKey(line, "agents", value)) {
+      agents = parseIntList(std::string(value));
+    } else if (TextParser::matchKey(line, "solver", value)) {
+      solvers = parseList(std::string(value));
+    } else if (TextParser::matchKey(line, "seed", value)) {
+      seeds = parseIntList(std::string(value));
+    } else if (TextParser::matchKey(line, "time_limit", value)) {
+      time_limits = parseIntList(std::string(value));
+    } else if (TextParser::matchKey(line, "threads", value)) {
+      threads = std::stoi(std::string(value));
+    } else if (TextParser::matchKey(line, "output", value)) {
+      output = std::string(value);
+    } else {
+      halt("unknown line, " + std::string(line));
+    }
+  }
+}
+
+void SweepConfig::addInstance(const std::string& instance)
+{
+  maps.push_back({instance, {}});
+}
+
+void SweepConfig::addScenario(const std::string& pattern)
+{
+  if (maps.empty()) halt("scenario " + pattern + " is given before instance");
+  glob_t g;
+  if (glob(pattern.c_str(), 0, nullptr, &g) != 0) {
+    globfree(&g);
+    halt("no scenario file matches " + pattern);
+  }
+  // sorted by glob
+  for (size_t k = 0; k < g.gl_pathc; ++k) {
+    maps.back().scenarios.push_back(g.gl_pathv[k]);
+  }
+  globfree(&g);
+}
+
+std::vector<std::string> SweepConfig::parseList(const std::string& str)
+{
+  std::vector<std::string> list;
+  size_t start = 0;
+  while (start <= str.size()) {
+    size_t end = str.find(',', start);
+    if (end == std::string::npos) end = str.size();
+    if (end > start) list.push_back(str.substr(start, end - start));
+    start = end + 1;
+  }
+  return list;
+}
+
+std::vector<int> SweepConfig::parseIntList(const std::string& str)
+{
+  std::vector<int> list;
+  for (auto& item : parseList(str)) {
+    int from, to, step = 1;
+    const int n = std::sscanf(item.c_str(), "%d:%d:%d", &from, &to, &step);
+    if (n == 1) {
+      list.push_back(from);
+    } else if (n >= 2 && step > 0) {
+      for (int x = from; x <= to; x += step) list.push_back(x);
+    } else {
+      halt("invalid list, " + str);
+    }
+  }
+  return list;
+}
+
+int SweepConfig::getRunsNum() const
+{
+  int num_scenarios = 0;
+  for (auto& map : maps) num_scenarios += map.scenarios.size();
+  return num_scenarios * agents.size() * solvers.size() * seeds.size() *
+         time_limits.size();
+}
+
+void SweepConfig::halt(const std::string& msg)
+{
+  throw std::runtime_error("error@SweepConfig: " + msg);
+}
+
+// -----------------------------------------------
+// sweep
+// -----------------------------------------------
+
+Sweep::Sweep(const SweepConfig& _config, SolverFactory _factory)
+    : config(_config),
+      factory(_factory),
+      distance_tables(config.maps.size()),
+      flex_tables(config.maps.size()),
+      json(false),
+      next_id(0)
+{
+  if (config.maps.empty()) halt("no instance");
+  for (auto& map : config.maps) {
+    if (map.scenarios.empty()) halt("no scenario for " + map.instance);
+  }
+  if (config.agents.empty()) halt("no number of agents");
+  if (config.solvers.empty()) halt("no solver");
+  if (config.seeds.empty()) halt("no seed");
+  if (config.time_limits.empty()) halt("no time limit");
+}
+
+Sweep::~Sweep() {}
+
+void Sweep::createTables(const int map_id)
+{
+  auto& map = config.maps[map_id];
+  auto P = MAPF_Instance(map.instance, map.scenarios.front(),
+                         config.agents.front());
+  auto solver = factory(config.solvers.front(), &P);
+  solver->createFlexTable();
+  distance_tables[map_id] = solver->getDistanceTable();
+  flex_tables[map_id] = solver->getFlexTable();
+}
+
+void Sweep::run()
+{
+  const std::string& output = config.output;
+  json = output.size() >= 5 && output.substr(output.size() - 5) == ".json";
+  out.open(output, std::ios::out);
+  if (!out) halt("cannot open " + output);
+  if (json) {
+    out << "[";
+  } else {
+    out << "instance,scenario,agents,solver,seed,time_limit,solved,valid,"
+        << "soc,soc_lb,makespan,makespan_lb,comp_time,error\n";
+  }
+
+  ThreadPool pool(config.threads);
+
+  // preprocessing, once for each map
+  for (int k = 0; k < (int)config.maps.size(); ++k) {
+    pool.submit([this, k] { createTables(k); });
+  }
+  pool.wait();
+
+  // main
+  int id = 0;
+  for (int k = 0; k < (int)config.maps.size(); ++k) {
+    auto& map = config.maps[k];
+    for (auto& scenario : map.scenarios) {
+      for (auto agents : config.agents) {
+        for (auto& solver : config.solvers) {
+          for (auto seed : config.seeds) {
+            for (auto time_limit : config.time_limits) {
+              SweepResult r = {id++,   map.instance, scenario,   agents,
+                               solver, seed,         time_limit, false,
+                               false,  0,            0,          0,
+                               0,      0,            ""};
+              pool.submit([this, r, k] { push(runOne(r, k)); });
+            }
+          }
+        }
+      }
+    }
+  }
+  pool.wait();
+
+  if (json) out << "\n]\n";
+  out.close();
+}
+
+SweepResult Sweep::runOne(SweepResult r, const int map_id)
+{
+  // an error of one run does not stop the others
+  try {
+    // each run has its own instance, i.e., its own random number generator
+    auto P = MAPF_Instance(r.instance, r.scenario, r.agents);
+    if (r.seed >= 0) P.setSeed(r.seed);
+    if (r.time_limit >= 0) P.setMaxCompTime(r.time_limit);
+
+    auto solver = factory(r.solver, &P);
+    solver->setDistanceTable(distance_tables[map_id]);
+    solver->setFlexTable(flex_tables[map_id]);
+    solver->setSummaryOnly(config.summary_only);
+    solver->solve();
+
+    r.solved = solver->succeed();
+    r.valid = config.summary_only || !r.solved ||
+              solver->getSolution().validate(&P);
+    r.soc = solver->getSOC();
+    r.soc_lb = solver->getLowerBoundSOC();
+    r.makespan = solver->getMakespan();
+    r.makespan_lb = solver->getLowerBoundMakespan();
+    r.comp_time = solver->getCompTime();
+  } catch (const std::exception& e) {
+    r.solved = false;
+    r.valid = false;
+    r.error = e.what();
+    warn("run " + std::to_string(r.id) + " failed, " + r.error);
+  }
+  return r;
+}
+
+void Sweep::push(SweepResult r)
+{
+  std::lock_guard<std::mutex> lk(out_mtx);
+  finished.emplace(r.id, std::move(r));
+  while (!finished.empty() && finished.begin()->first == next_id) {
+    write(finished.begin()->second);
+    results.push_back(std::move(finished.begin()->second));
+    finished.erase(finished.begin());
+    ++next_id;
+  }
+  out.flush();
+}
+
+// minimal escaping, enough for file names and error messages
+static std::string quote(const std::string& str)
+{
+  std::string s = "\"";
+  for (auto c : str) {
+    if (c == '\n') {
+      s += "\\n";
+      continue;
+    }
+    if (c == '"' || c == '\\') s += '\\';
+    s += c;
+  }
+  return s + "\"";
+}
+
+static std::string quoteCSV(const std::string& str)
+{
+  std::string s = "\"";
+  for (auto c : str) {
+    if (c == '"') s += '"';
+    s += c;
+  }
+  return s + "\"";
+}
+
+void Sweep::write(const SweepResult& r)
+{
+  if (json) {
+    out << (r.id == 0 ? "\n" : ",\n") << "{\"instance\":" << quote(r.instance)
+        << ",\"scenario\":" << quote(r.scenario) << ",\"agents\":" << r.agents
+        << ",\"solver\":" << quote(r.solver) << ",\"seed\":" << r.seed
+        << ",\"time_limit\":" << r.time_limit
+        << ",\"solved\":" << (r.solved ? "true" : "false")
+        << ",\"valid\":" << (r.valid ? "true" : "false") << ",\"soc\":" << r.soc
+        << ",\"soc_lb\":" << r.soc_lb << ",\"makespan\":" << r.makespan
+        << ",\"makespan_lb\":" << r.makespan_lb
+        << ",\"comp_time\":" << r.comp_time
+        << ",\"error\":" << quote(r.error) << "}";
+  } else {
+    out << r.instance << "," << r.scenario << "," << r.agents << ","
+        << r.solver << "," << r.seed << "," << r.time_limit << ","
+        << r.solved << "," << r.valid << "," << r.soc << "," << r.soc_lb
+        << "," << r.makespan << "," << r.makespan_lb << "," << r.comp_time
+        << "," << (r.error.empty() ? "" : quoteCSV(r.error)) << "\n";
+  }
+}
+
+void Sweep::printSummary() const
+{
+  struct Stat {
+    int runs = 0;
+    int success = 0;
+    float sum_time = 0;
+    float sum_soc_over_lb = 0;
+    float sum_makespan_over_lb = 0;
+  };
+  std::map<std::tuple<std::string, std::string, int>, Stat> stats;
+  for (auto& r : results) {
+    auto& stat = stats[{r.instance, r.solver, r.agents}];
+    ++stat.runs;
+    if (!r.solved) continue;
+    ++stat.success;
+    stat.sum_time += r.comp_time;
+    stat.sum_soc_over_lb += (float)r.soc / r.soc_lb;
+    stat.sum_makespan_over_lb += (float)r.makespan / r.makespan_lb;
+  }
+
+  std::cout << "instance,solver,agents,success_rate,comp_time,soc/lb,"
+               "makespan/lb\n"
+            << std::fixed << std::setprecision(5);
+  for (auto& [key, stat] : stats) {
+    std::cout << std::get<0>(key) << "," << std::get<1>(key) << ","
+              << std::get<2>(key) << "," << (float)stat.success / stat.runs
+              << "," << stat.sum_time / stat.success << ","
+              << stat.sum_soc_over_lb / stat.success << ","
+              << stat.sum_makespan_over_lb / stat.success << "\n";
+  }
+  std::cout << std::defaultfloat << std::flush;
+}
+
+void Sweep::halt(const std::string& msg) const
+{
+  throw std::runtime_error("error@Sweep: " + msg);
+}
+
+void Sweep::warn(const std::string& msg) const
+{
+  // single insertion, not interleaved with other threads
+  std::cout << "warn@Sweep: " + msg + "\n" << std::flush;
+}
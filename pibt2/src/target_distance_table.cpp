@@ -0,0 +1,50 @@
+#include "../include/target_distance_table.hpp"
+
+#include <algorithm>
+
+#include "../include/thread_pool.hpp"
+
+TargetDistanceTable::TargetDistanceTable(Graph* G, const Nodes& targets,
+                                         int num_threads)
+    : row(G->getNodesSize(), -1)
+{
+  for (auto g : targets) {
+    if (row[g->id] != -1) continue;  // duplicated
+    row[g->id] = fields.size();
+    fields.emplace_back();
+  }
+  if (fields.empty()) return;
+
+  // rows are assigned to workers in turn
+  Nodes rows(fields.size());
+  for (auto g : targets) rows[row[g->id]] = g;
+  if (num_threads <= 0) num_threads = std::thread::hardware_concurrency();
+  num_threads = std::max(1, std::min(num_threads, (int)rows.size()));
+  ThreadPool pool(num_threads);
+  for (int j = 0; j < num_threads; ++j) {
+    pool.submit([&, j] {
+      for (int k = j; k < (int)rows.size(); k += num_threads) {
+        computeField(G, rows[k], fields[k]);
+      }
+    });
+  }
+  pool.wait();
+}
+
+void TargetDistanceTable::computeField(Graph* G, Node* const g,
+                                       std::vector<int>& field)
+{
+  const int nodes_num = G->getNodesSize();
+  field.assign(nodes_num, nodes_num);
+  field[g->id] = 0;
+  Nodes OPEN = {g};
+  for (int head = 0; head < (int)OPEN.size(); ++head) {
+    Node* v = OPEN[head];
+    const int d = field[v->id] + 1;
+    for (auto u : v->neighbor) {
+      if (field[u->id] != nodes_num) continue;
+      field[u->id] = d;
+      OPEN.push_back(u);
+    }
+  }
+}
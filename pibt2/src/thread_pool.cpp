@@ -0,0 +1,65 @@
+#include "../include/thread_pool.hpp"
+
+#include <utility>
+
+ThreadPool::ThreadPool(int num_threads) : running(0), closing(false)
+{
+  if (num_threads <= 0) num_threads = std::thread::hardware_concurrency();
+  if (num_threads <= 0) num_threads = 1;
+  for (int k = 0; k < num_threads; ++k) {
+    workers.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    closing = true;
+  }
+  cv_job.notify_all();
+  for (auto& worker : workers) worker.join();
+}
+
+void ThreadPool::work()
+{
+  while (true) {
+    std::function<void()> job;
+    {
+      std::unique_lock<std::mutex> lk(mtx);
+      cv_job.wait(lk, [&] { return !jobs.empty() || closing; });
+      if (jobs.empty()) return;  // closing
+      job = std::move(jobs.front());
+      jobs.pop();
+      ++running;
+    }
+    std::exception_ptr e;
+    try {
+      job();
+    } catch (...) {
+      e = std::current_exception();
+    }
+    {
+      std::lock_guard<std::mutex> lk(mtx);
+      if (e && !error) error = e;
+      --running;
+      if (running == 0 && jobs.empty()) cv_idle.notify_all();
+    }
+  }
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lk(mtx);
+    jobs.push(std::move(job));
+  }
+  cv_job.notify_one();
+}
+
+void ThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lk(mtx);
+  cv_idle.wait(lk, [&] { return running == 0 && jobs.empty(); });
+  if (error) std::rethrow_exception(std::exchange(error, nullptr));
+}
@@ -3,7 +3,7 @@
 const std::string TP::SOLVER_NAME = "TP";
 
 TP::TP(MAPD_Instance* _P, bool _use_distance_table)
-    : MAPD_Solver(_P, _use_distance_table)
+    : MAPD_Solver(_P, _use_distance_table), CONFLICT_TABLE(G->getNodesSize())
 {
   solver_name = TP::SOLVER_NAME;
 }
@@ -13,24 +13,18 @@ void TP::run()
   std::vector<Path> TOKEN(P->getNum());
   Agents A;
 
-  // initialize conflict table
-  {
-    CONFLICT_TABLE.push_back(std::vector<int>(G->getNodesSize(), NIL));
-  }
-
+  initialize(TOKEN);
   for (int i = 0; i < P->getNum(); ++i) {
-    Node* s = P->getStart(i);
     Agent* a = new Agent{
-        i,        // id
-        s,        // current location
-        nullptr,  // task
-        false     // load_task
+        i,               // id
+        P->getStart(i),  // current location
+        nullptr,         // task
+        false            // load_task
     };
     A.push_back(a);
-    // line 2, initialize
-    TOKEN[i].push_back(s);
   }
-  solution.add(P->getConfigStart());
+  solution.setSummaryOnly(summary_only);
+  appendConfig(P->getConfigStart());
 
   // line 3
   while (true) {
@@ -41,6 +35,10 @@ void TP::run()
          ", task_num:", P->getTaskNum());
 
     // line 4, get unassigned tasks
+    for (; registered_task_num < P->getCreatedTaskNum();
+         ++registered_task_num) {
+      ++deliveries[P->getTask(registered_task_num)->loc_delivery->id];
+    }
     Tasks unassigned_tasks;
     for (auto task : P->getOpenTasks()) {
       if (!task->assigned) unassigned_tasks.push_back(task);
@@ -66,12 +64,10 @@ void TP::run()
       for (auto task : unassigned_tasks) {
         if (task->assigned) continue;  // line 11
 
-        bool cond = std::all_of(A.begin(), A.end(), [&](Agent* b) {
-          if (b == a) return true;
-          auto v = *(TOKEN[b->id].end() - 1);
-          return v != task->loc_pickup && v != task->loc_delivery;
-        });
-        if (cond) selected_tasks.push_back(task);
+        // no path of other agents ends in pickup or delivery location
+        if (isOthersTail(a->id, task->loc_pickup, TOKEN)) continue;
+        if (isOthersTail(a->id, task->loc_delivery, TOKEN)) continue;
+        selected_tasks.push_back(task);
       }
 
       if (!selected_tasks.empty()) {  // line 8
@@ -86,45 +82,35 @@ void TP::run()
         // line 10, assign
         a->task = task;
         task->assigned = true;
+        --deliveries[task->loc_delivery->id];
         tasks[a->id] = task;
         targets[a->id] = task->loc_pickup;
         info("   ", "assign task-", task->id, ": agent-", a->id, "at",
              a->v_now->id, ",", task->loc_pickup->id, " -> ",
              task->loc_delivery->id);
+        appendTaskEvent(TaskEvent::ASSIGNED, task, a->id,
+                        P->getCurrentTimestep());
 
         // line 12
         updatePath1(a->id, task, TOKEN);
 
         // line 13
-      } else if (std::all_of(unassigned_tasks.begin(), unassigned_tasks.end(),
-                             [&](Task* task) {
-                               return task->assigned ||
-                                      task->loc_delivery != a->v_now;
-                             })) {
+      } else if (deliveries[a->v_now->id] == 0) {
         // line 14
-        TOKEN[a->id].push_back(a->v_now);
-
-        // update conflict table
-        {
-          while (CONFLICT_TABLE.size() - 1 < TOKEN[a->id].size() - 1) {
-            CONFLICT_TABLE.push_back(std::vector<int>(G->getNodesSize(), NIL));
-          }
-          CONFLICT_TABLE[P->getCurrentTimestep() + 1][a->v_now->id] = a->id;
-        }
+        extendToken(a->id, {a->v_now}, TOKEN);
 
         targets[a->id] = a->v_now;
 
         // line 15
       } else {
         // line 16
-        updatePath2(a->id, TOKEN, unassigned_tasks);
+        updatePath2(a->id, TOKEN);
 
         targets[a->id] = *(TOKEN[a->id].end() - 1);
       }
     }
 
-    hist_targets.push_back(targets);
-    hist_tasks.push_back(tasks);
+    appendTargets(targets, tasks);
 
     Config config(P->getNum(), nullptr);
     for (auto a : A) {
@@ -144,12 +130,16 @@ void TP::run()
           // finish task
           info("   ", "finish task-", a->task->id, ": agent-", a->id, ", ",
                a->task->loc_pickup->id, " -> ", a->task->loc_delivery->id);
+          appendTaskEvent(TaskEvent::DELIVERED, a->task, a->id,
+                          P->getCurrentTimestep() + 1);
           a->task = nullptr;
           a->load_task = false;
 
           // start loc -> pickup loc
         } else if (!a->load_task && a->v_now == a->task->loc_pickup) {
           a->load_task = true;
+          appendTaskEvent(TaskEvent::PICKED, a->task, a->id,
+                          P->getCurrentTimestep() + 1);
         }
 
       } else {
@@ -159,10 +149,12 @@ void TP::run()
     }
 
     // update plan
-    solution.add(config);
+    appendConfig(config);
 
     // increment timestep
     P->update();
+    // past reservations are no longer referred
+    CONFLICT_TABLE.advance(P->getCurrentTimestep());
 
     // failure
     if (P->getCurrentTimestep() >= max_timestep || overCompTime()) {
@@ -185,134 +177,229 @@ void TP::run()
       targets.push_back(*(TOKEN[a->id].end() - 1));
       tasks.push_back(a->task);
     }
-    hist_targets.push_back(targets);
-    hist_tasks.push_back(tasks);
+    appendTargets(targets, tasks);
   }
 
   // memory clear
   for (auto a : A) delete a;
 }
 
+void TP::initialize(std::vector<Path>& TOKEN)
+{
+  CONFLICT_TABLE = ReservationTable(G->getNodesSize());
+  token_tails.assign(G->getNodesSize(), 0);
+  tail_agent.assign(G->getNodesSize(), NIL);
+  last_reserved.assign(G->getNodesSize(), NIL);
+  deliveries.assign(G->getNodesSize(), 0);
+  registered_task_num = 0;
+  endpoint_order.assign(G->getNodesSize(), NIL);
+  auto& endpoints = P->getEndpoints();
+  for (int k = endpoints.size() - 1; k >= 0; --k) {
+    endpoint_order[endpoints[k]->id] = k;
+  }
+  visited.assign(G->getNodesSize(), 0);
+  visited_stamp = 0;
+
+  // line 2, initialize
+  TOKEN.assign(P->getNum(), Path());
+  for (int i = 0; i < P->getNum(); ++i) {
+    Node* s = P->getStart(i);
+    TOKEN[i].push_back(s);
+    ++token_tails[s->id];
+    tail_agent[s->id] = i;
+    last_reserved[s->id] = 0;
+  }
+}
+
 void TP::updatePath1(int i, Task* task, std::vector<Path>& TOKEN)
 {
   info("   ", "updatePath1, agent-", i);
 
-  // find path: loc -> pickup location
-  updatePath(i, task->loc_pickup, TOKEN);
-  // find path: pickup location -> delivery location
-  updatePath(i, task->loc_delivery, TOKEN);
+  // find path: loc -> pickup location -> delivery location
+  updatePath(i, {task->loc_pickup, task->loc_delivery}, TOKEN);
 }
 
-void TP::updatePath2(int i, std::vector<Path>& TOKEN, Tasks& unassigned_tasks)
+void TP::updatePath2(int i, std::vector<Path>& TOKEN)
 {
   info("   ", "updatePath2, agent-", i);
 
-  Node* target;
-  Node* loc = TOKEN[i][P->getCurrentTimestep()];
-  int estimated_cost = G->getNodesSize();
-  for (auto p : P->getEndpoints()) {
+  Node* target = findEndpoint(i, TOKEN);
+  if (target == nullptr) halt("this is not well-formed instance");
+
+  // find path: loc -> target
+  updatePath(i, {target}, TOKEN);
+}
+
+Node* TP::findEndpoint(int i, const std::vector<Path>& TOKEN)
+{
+  auto isCandidate = [&](Node* p) {
+    if (endpoint_order[p->id] == NIL) return false;
     /*
      * the delivery locations of all tasks in the task set
      * are different from the chosen endpoint
      */
-    bool cond1 = std::all_of(
-        unassigned_tasks.begin(), unassigned_tasks.end(),
-        [&](Task* task) { return task->assigned || task->loc_delivery != p; });
-    if (!cond1) continue;
-
+    if (deliveries[p->id] > 0) return false;
     /*
      * no path of other agents in the token ends in the chosen endpoint
      */
-    bool cond2 = true;
-    for (int j = 0; j < P->getNum(); ++j) {
-      if (j == i) continue;
-      if (*(TOKEN[j].end() - 1) == p) {
-        cond2 = false;
-        break;
+    return !isOthersTail(i, p, TOKEN);
+  };
+
+  // nearest candidate by BFS, ties are broken by the order of endpoints
+  Node* target = nullptr;
+  Node* loc = TOKEN[i][P->getCurrentTimestep()];
+  ++visited_stamp;
+  visited[loc->id] = visited_stamp;
+  Nodes layer = {loc};
+  Nodes next;
+  while (!layer.empty()) {
+    for (auto v : layer) {
+      if (!isCandidate(v)) continue;
+      if (target == nullptr ||
+          endpoint_order[v->id] < endpoint_order[target->id]) {
+        target = v;
       }
     }
-    if (!cond2) continue;
-
-    // update target
-    int d = pathDist(loc, p);
-    if (d < estimated_cost) {
-      target = p;
-      estimated_cost = d;
+    if (target != nullptr) break;
+
+    next.clear();
+    for (auto v : layer) {
+      for (auto u : v->neighbor) {
+        if (visited[u->id] == visited_stamp) continue;
+        visited[u->id] = visited_stamp;
+        next.push_back(u);
+      }
     }
+    std::swap(layer, next);
   }
 
-  if (target == nullptr) halt("this is not well-formed instance");
-
-  // find path: loc -> target
-  updatePath(i, target, TOKEN);
+  return target;
 }
 
-void TP::updatePath(int i, Node* g, std::vector<Path>& TOKEN)
+void TP::updatePath(int i, const Nodes& waypoints, std::vector<Path>& TOKEN)
 {
-  auto s = *(TOKEN[i].end() - 1);
+  auto s = TOKEN[i].back();
   const int current_timestep = (int)TOKEN[i].size() - 1;
-
-  // someone may use g
-  int max_constraint_time = current_timestep;
-  for (int j = 0; j < P->getNum(); ++j) {
-    for (int t = (int)TOKEN[j].size() - 1; t > max_constraint_time; --t) {
-      if (j != i && TOKEN[j][t] == g) {
-        max_constraint_time = std::max(t, max_constraint_time);
-        break;
-      }
+  const int W = waypoints.size();
+  const long long V = G->getNodesSize();
+
+  // someone may use waypoints, own path never reaches beyond current_timestep
+  std::vector<int> max_constraint_time(W);
+  // distance from each waypoint to the last one, through the others
+  std::vector<int> rest_dist(W, 0);
+  for (int k = W - 1; k >= 0; --k) {
+    max_constraint_time[k] =
+        std::max(current_timestep, last_reserved[waypoints[k]->id]);
+    if (k < W - 1) {
+      rest_dist[k] =
+          rest_dist[k + 1] + pathDist(waypoints[k], waypoints[k + 1]);
     }
   }
 
-  AstarHeuristics fValue = [&](AstarNode* n) {
-    return n->g + pathDist(n->v, g);
+  // (node, time, stage)
+  auto getKey = [&](Node* v, const int g, const int stage) {
+    return ((long long)g * W + stage) * V + v->id;
   };
 
-  CheckAstarFin checkAstarFin = [&](AstarNode* n) {
-    return n->v == g && n->g + current_timestep > max_constraint_time;
+  // same order as compareAstarNodeBasic
+  auto compare = [&](const int a, const int b) {
+    const auto& n = search_nodes[a];
+    const auto& m = search_nodes[b];
+    if (n.f != m.f) return n.f > m.f;
+    if (n.g != m.g) return n.g < m.g;
+    return false;
   };
+  std::priority_queue<int, std::vector<int>, decltype(compare)> OPEN(compare);
 
-  std::vector<int> token_endpoints(G->getNodesSize(), NIL);
-  for (int j = 0; j < P->getNum(); ++j) {
-    if (j == i) continue;
-    token_endpoints[(*(TOKEN[j].end() - 1))->id] = j;
-  }
+  auto push = [&](Node* v, const int g, const int stage, const int parent) {
+    const int f = g + pathDist(v, waypoints[stage]) + rest_dist[stage];
+    search_nodes.push_back({v, g, f, stage, parent});
+    OPEN.push(search_nodes.size() - 1);
+  };
 
-  CheckInvalidAstarNode checkInvalidAstarNode = [&](AstarNode* m) {
-    auto t = current_timestep + m->g;
+  // move u -> v, arriving at t
+  auto isInvalid = [&](Node* u, Node* v, const int t) {
     // avoid endpoints
-    auto k = token_endpoints[m->v->id];
-    if (k != NIL && (int)TOKEN[k].size() - 1 < t) return true;
-    // avoid conflicts
-    if ((int)CONFLICT_TABLE.size() - 1 >= t) {
-      // check vertex conflicts
-      if (CONFLICT_TABLE[t][m->v->id] != NIL) return true;
-      // check swap conflicts
-      if (CONFLICT_TABLE[t][m->p->v->id] != NIL &&
-          CONFLICT_TABLE[t - 1][m->v->id] == CONFLICT_TABLE[t][m->p->v->id])
-        return true;
-    }
-
-    return false;
+    const int k = tail_agent[v->id];
+    if (k != NIL && k != i && (int)TOKEN[k].size() - 1 < t) return true;
+    // check vertex conflicts
+    if (CONFLICT_TABLE.get(t, v->id) != NIL) return true;
+    // check swap conflicts
+    const int l = CONFLICT_TABLE.get(t, u->id);
+    return l != NIL && CONFLICT_TABLE.get(t - 1, v->id) == l;
   };
 
-  // get path
-  auto path = getPathBySpaceTimeAstar(s, g, fValue, compareAstarNodeBasic,
-                                      checkAstarFin, checkInvalidAstarNode,
-                                      getRemainedTime());
+  search_nodes.clear();
+  search_closed.clear();
+  push(s, 0, 0, NIL);
+  int goal = NIL;
+  while (!OPEN.empty()) {
+    // check time limit
+    if (deadline.expired()) break;
+
+    // minimum node, copied since search_nodes may grow
+    const int j = OPEN.top();
+    OPEN.pop();
+    const SearchNode n = search_nodes[j];
+
+    // check CLOSE list
+    if (!search_closed.insert(getKey(n.v, n.g, n.stage)).second) continue;
+
+    // check waypoint
+    const int t = current_timestep + n.g;
+    if (n.v == waypoints[n.stage] && t > max_constraint_time[n.stage]) {
+      if (n.stage == W - 1) {
+        goal = j;
+        break;
+      }
+      // to the next waypoint, from the same node and time
+      push(n.v, n.g, n.stage + 1, n.parent);
+      continue;
+    }
 
-  if (path.empty()) halt("failed");
+    // expand, neighbors then staying
+    for (int k = 0; k <= (int)n.v->neighbor.size(); ++k) {
+      Node* u = (k < (int)n.v->neighbor.size()) ? n.v->neighbor[k] : n.v;
+      if (search_closed.count(getKey(u, n.g + 1, n.stage)) > 0) continue;
+      if (isInvalid(n.v, u, t + 1)) continue;
+      push(u, n.g + 1, n.stage, j);
+    }
+  }
 
-  // update conflict table
-  while (CONFLICT_TABLE.size() - 1 < current_timestep + path.size() - 1) {
-    CONFLICT_TABLE.push_back(std::vector<int>(G->getNodesSize(), NIL));
+  Path path;
+  for (int j = goal; j != NIL; j = search_nodes[j].parent) {
+    path.push_back(search_nodes[j].v);
+  }
+  std::reverse(path.begin(), path.end());
+
+  if (path.empty()) {
+    if (!overCompTime()) halt("failed");
+    // stop by deadline, stay until run() terminates at this timestep
+    path = {s, s};
   }
 
   // update TOKEN
-  for (int _t = 1; _t < (int)path.size(); ++_t) {
-    TOKEN[i].push_back(path[_t]);
+  extendToken(i, Nodes(path.begin() + 1, path.end()), TOKEN);
+}
+
+void TP::extendToken(int i, const Nodes& path, std::vector<Path>& TOKEN)
+{
+  if (path.empty()) return;
+
+  // tail, other tails may be passed on the way
+  Node* tail = TOKEN[i].back();
+  --token_tails[tail->id];
+  ++token_tails[path.back()->id];
+  if (tail_agent[tail->id] == i) tail_agent[tail->id] = NIL;
+  tail_agent[path.back()->id] = i;
+
+  for (auto v : path) {
+    TOKEN[i].push_back(v);
+    const int t = (int)TOKEN[i].size() - 1;
+    last_reserved[v->id] = std::max(last_reserved[v->id], t);
 
     // update conflict table
-    CONFLICT_TABLE[current_timestep + _t][path[_t]->id] = i;
+    CONFLICT_TABLE.set(t, v->id, i);
   }
 }
 
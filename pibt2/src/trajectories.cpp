@@ -0,0 +1,170 @@
+#include "../include/trajectories.hpp"
+
+#include <algorithm>
+#include <iostream>
+
+Trajectories::Trajectories(Layout _primary, int _num_agents)
+    : dict(std::make_shared<Nodes>()),
+      primary(_primary),
+      num_agents(_num_agents),
+      horizon(0),
+      lengths(_num_agents, 0),
+      stride(0),
+      synced(true)
+{
+}
+
+int Trajectories::getHorizon() const
+{
+  if (primary == TIME_MAJOR) return horizon;
+  return lengths.empty() ? 0 : *std::max_element(lengths.begin(), lengths.end());
+}
+
+void Trajectories::sync() const
+{
+  if (synced) return;
+  if (primary == TIME_MAJOR) {
+    // configurations -> paths
+    stride = horizon;
+    lengths.assign(num_agents, horizon);
+    by_agent.resize(num_agents * stride);
+    for (int t = 0; t < horizon; ++t) {
+      const uint32_t* c = by_time.data() + t * num_agents;
+      for (int i = 0; i < num_agents; ++i) by_agent[i * stride + t] = c[i];
+    }
+  } else {
+    // paths -> configurations, empty paths are not allowed to read
+    horizon = getHorizon();
+    by_time.resize(num_agents * horizon);
+    for (int i = 0; i < num_agents; ++i) {
+      const uint32_t* p = by_agent.data() + i * stride;
+      const int len = lengths[i];
+      for (int t = 0; t < horizon; ++t) {
+        by_time[t * num_agents + i] =
+            len == 0 ? UINT32_MAX : p[t < len ? t : len - 1];
+      }
+    }
+  }
+  synced = true;
+}
+
+uint32_t Trajectories::encode(Node* v)
+{
+  const int id = v->id;
+  if (id >= (int)dict->size()) dict->resize(id + 1, nullptr);
+  Node*& slot = (*dict)[id];
+  if (slot != v) {
+    // copies share the dictionary, detach before overwriting
+    if (slot != nullptr && dict.use_count() > 1) {
+      dict = std::make_shared<Nodes>(*dict);
+    }
+    (*dict)[id] = v;
+  }
+  return id;
+}
+
+void Trajectories::reserveStride(int new_stride)
+{
+  std::vector<uint32_t> buf(num_agents * new_stride);
+  for (int i = 0; i < num_agents; ++i) {
+    std::copy(by_agent.begin() + i * stride,
+              by_agent.begin() + i * stride + lengths[i],
+              buf.begin() + i * new_stride);
+  }
+  by_agent.swap(buf);
+  stride = new_stride;
+}
+
+void Trajectories::setLayout(Layout layout)
+{
+  if (layout == primary) return;
+  // rebuild the new primary even when synced, since the secondary may lack
+  // padding of the old primary, e.g., configurations padded to horizon
+  synced = false;
+  sync();
+  primary = layout;
+  synced = false;  // old primary is rebuilt from the new one on demand
+}
+
+void Trajectories::clear()
+{
+  by_time.clear();
+  horizon = 0;
+  by_agent.clear();
+  lengths.assign(num_agents, 0);
+  stride = 0;
+  synced = true;
+}
+
+void Trajectories::addConfig(const Nodes& c)
+{
+  if (primary != TIME_MAJOR) halt("invalid operation");
+  if (horizon == 0 && num_agents == 0) num_agents = c.size();
+  if ((int)c.size() != num_agents) halt("invalid configuration size");
+  for (auto v : c) by_time.push_back(encode(v));
+  ++horizon;
+  synced = false;
+}
+
+NodesView Trajectories::getConfig(int t) const
+{
+  if (primary == AGENT_MAJOR) sync();
+  return NodesView(by_time.data() + t * num_agents, dict.get(), num_agents,
+                   num_agents);
+}
+
+void Trajectories::setPath(int i, const Path& path)
+{
+  if (primary != AGENT_MAJOR) halt("invalid operation");
+  const int len = path.size();
+  if (len > stride) reserveStride(std::max(len, stride * 2));
+  uint32_t* p = by_agent.data() + i * stride;
+  for (int t = 0; t < len; ++t) p[t] = encode(path[t]);
+  lengths[i] = len;
+  synced = false;
+}
+
+void Trajectories::clearPath(int i)
+{
+  if (primary != AGENT_MAJOR) halt("invalid operation");
+  lengths[i] = 0;
+  synced = false;
+}
+
+void Trajectories::resizePath(int i, int len)
+{
+  if (primary != AGENT_MAJOR) halt("invalid operation");
+  const int old_len = lengths[i];
+  if (len > old_len) {
+    if (old_len == 0) halt("cannot pad empty path");
+    if (len > stride) reserveStride(std::max(len, stride * 2));
+    uint32_t* p = by_agent.data() + i * stride;
+    std::fill(p + old_len, p + len, p[old_len - 1]);
+  }
+  lengths[i] = len;
+  synced = false;
+}
+
+int Trajectories::getPathLength(int i) const
+{
+  if (primary == TIME_MAJOR) return horizon;
+  return lengths[i];
+}
+
+NodesView Trajectories::getPath(int i, int len) const
+{
+  if (primary == TIME_MAJOR) sync();
+  return NodesView(by_agent.data() + i * stride, dict.get(), lengths[i], len);
+}
+
+Node* Trajectories::get(int t, int i) const
+{
+  if (primary == TIME_MAJOR) return (*dict)[by_time[t * num_agents + i]];
+  const int len = lengths[i];
+  return (*dict)[by_agent[i * stride + (t < len ? t : len - 1)]];
+}
+
+void Trajectories::halt(const std::string& msg) const
+{
+  throw std::runtime_error("error@Trajectories: " + msg);
+}
@@ -0,0 +1,129 @@
+#include <getopt.h>
+
+#include <default_params.hpp>
+#include <fstream>
+#include <iostream>
+#include <plan_stream.hpp>
+
+void printHelp();
+int run(int argc, char* argv[]);
+
+int main(int argc, char* argv[])
+{
+  // errors of the library are thrown as std::runtime_error
+  try {
+    return run(argc, argv);
+  } catch (const std::exception& e) {
+    std::cout << e.what() << std::endl;
+    return 1;
+  }
+}
+
+int run(int argc, char* argv[])
+{
+  std::string input_file = "";
+  std::string output_file = DEFAULT_OUTPUT_FILE;
+
+  struct option longopts[] = {
+      {"input", required_argument, 0, 'i'},
+      {"output", required_argument, 0, 'o'},
+      {"help", no_argument, 0, 'h'},
+      {0, 0, 0, 0},
+  };
+
+  // command line args
+  int opt, longindex;
+  opterr = 0;  // ignore getopt error
+  while ((opt = getopt_long(argc, argv, "i:o:h", longopts, &longindex)) !=
+         -1) {
+    switch (opt) {
+      case 'i':
+        input_file = std::string(optarg);
+        break;
+      case 'o':
+        output_file = std::string(optarg);
+        break;
+      case 'h':
+        printHelp();
+        return 0;
+      default:
+        break;
+    }
+  }
+
+  if (input_file.length() == 0) {
+    std::cout << "specify binary result file using -i [FILE], e.g.,"
+              << std::endl;
+    std::cout << "> ./plan_converter -i ./result.bin -o ./result.txt"
+              << std::endl;
+    return 0;
+  }
+
+  BinaryPlanReader reader(input_file);
+  const int width = reader.getWidth();
+  const int num_agents = reader.getNum();
+  std::ofstream log;
+  log.open(output_file, std::ios::out);
+  auto printNode = [&](const uint32_t v_id) {
+    log << "(" << v_id % width << "," << v_id / width << ")";
+  };
+
+  // same as makeLog of solvers
+  log << reader.getInfo();
+  log << "starts=";
+  for (auto v_id : reader.getStarts()) {
+    printNode(v_id);
+    log << ",";
+  }
+  if (reader.isMAPD()) {
+    log << "\n";
+    log << "task=\n";
+    log << reader.getTasksInfo();
+  } else {
+    log << "\ngoals=";
+    for (auto v_id : reader.getGoals()) {
+      printNode(v_id);
+      log << ",";
+    }
+    log << "\n";
+  }
+  log << "solution=\n";
+
+  // targets of a timestep follow its configuration, so that each
+  // configuration is written when the next one (or END) is read
+  const bool with_targets = reader.hasTargets();
+  std::vector<uint32_t> config;
+  int t = 0;
+  auto writeConfig = [&]() {
+    log << t++ << ":";
+    for (int i = 0; i < num_agents; ++i) {
+      printNode(config[i]);
+      if (with_targets) {
+        log << "->";
+        printNode(reader.getTargets()[i]);
+        log << ":" << reader.getTasks()[i];
+      }
+      log << ",";
+    }
+    log << "\n";
+  };
+  PlanFormat::Record record;
+  while ((record = reader.next()) != PlanFormat::END) {
+    if (record != PlanFormat::CONFIG) continue;  // others update targets
+    if (!config.empty()) writeConfig();
+    config = reader.getConfig();
+  }
+  if (!config.empty()) writeConfig();
+  log.close();
+
+  return 0;
+}
+
+void printHelp()
+{
+  std::cout << "\nUsage: ./plan_converter [OPTIONS]\n"
+            << "\nconvert binary result file to text format\n\n"
+            << "  -i --input [FILE_PATH]        binary result file path\n"
+            << "  -o --output [FILE_PATH]       ouptut file path\n"
+            << "  -h --help                     help" << std::endl;
+}
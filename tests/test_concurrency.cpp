@@ -0,0 +1,135 @@
+#include <hca.hpp>
+#include <option_scanner.hpp>
+#include <pibt.hpp>
+#include <pibt_mapd.hpp>
+#include <pibt_plus.hpp>
+#include <thread>
+#include <tp.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(OptionScanner, scan)
+{
+  const char* args[] = {"mapf", "-i", "ins.txt", "-dc", "5", "--cycle-lim=7",
+                        "x", "--foo", "-k", "--disable-dist-init", "--", "-d"};
+  struct option longopts[] = {
+      {"disable-dist-init", no_argument, 0, 'd'},
+      {"cycle-limit", required_argument, 0, 'c'},
+      {0, 0, 0, 0},
+  };
+  OptionScanner scanner(12, const_cast<char**>(args), "dc:", longopts);
+  ASSERT_EQ(scanner.next(), '?');  // -i
+  ASSERT_EQ(scanner.next(), 'd');
+  ASSERT_EQ(scanner.next(), 'c');
+  ASSERT_STREQ(scanner.arg(), "5");
+  ASSERT_EQ(scanner.next(), 'c');
+  ASSERT_STREQ(scanner.arg(), "7");
+  ASSERT_EQ(scanner.next(), '?');  // --foo
+  ASSERT_EQ(scanner.next(), '?');  // -k
+  ASSERT_EQ(scanner.next(), 'd');
+  ASSERT_EQ(scanner.next(), -1);  // after "--"
+  ASSERT_EQ(scanner.next(), -1);
+}
+
+TEST(Concurrency, error)
+{
+  ASSERT_THROW(MAPD_Instance("../tests/instances/not_found.txt"),
+               std::runtime_error);
+}
+
+TEST(Concurrency, cancel)
+{
+  auto P = MAPF_Instance("../tests/instances/toy_problem.txt", "", 8);
+  P.setMaxCompTime(60000);
+  Deadline deadline;
+  deadline.cancel();
+
+  auto solver1 = std::make_unique<HCA>(&P);
+  solver1->createFlexTable();
+  solver1->setDeadline(deadline);
+  solver1->solve();
+  ASSERT_FALSE(solver1->succeed());
+
+  // nested solvers are stopped too
+  auto solver2 = std::make_unique<PIBT_PLUS>(&P);
+  solver2->createFlexTable();
+  solver2->setDeadline(deadline);
+  solver2->solve();
+  ASSERT_FALSE(solver2->succeed());
+}
+
+struct Result {
+  int cost;
+  int makespan;
+  bool valid;
+
+  bool operator==(const Result& other) const
+  {
+    return cost == other.cost && makespan == other.makespan &&
+           valid == other.valid;
+  }
+};
+
+static Result solve(const int k)
+{
+  const char* args[] = {"test", "-d", "--cycle-limit", "100"};
+  char** argv = const_cast<char**>(args);
+  const int time_limit = 60000;  // results must not depend on the load
+
+  if (k % 2 == 0) {
+    auto P = MAPD_Instance("../tests/instances/test_mapd_pibt_ins.txt");
+    P.setMaxCompTime(time_limit);
+    std::unique_ptr<MAPD_Solver> solver;
+    if (k % 4 == 0) {
+      solver = std::make_unique<PIBT_MAPD>(&P);
+    } else {
+      solver = std::make_unique<TP>(&P);
+    }
+    solver->setParams(4, argv);
+    solver->solve();
+    // task ids are given by each instance
+    for (auto task : P.getClosedTasks()) {
+      if (task->id < 0 || task->id >= (int)P.getTaskNum()) {
+        return {-1, -1, false};
+      }
+    }
+    return {(int)solver->getTotalServiceTime(),
+            solver->getSolution().getMakespan(),
+            solver->succeed() && solver->getSolution().validate(&P)};
+  }
+
+  auto P = MAPF_Instance("../tests/instances/toy_problem.txt", "", 8);
+  P.setMaxCompTime(time_limit);
+  std::unique_ptr<MAPF_Solver> solver;
+  if (k % 4 == 1) {
+    solver = std::make_unique<PIBT>(&P);
+  } else {
+    solver = std::make_unique<HCA>(&P);
+  }
+  solver->setParams(4, argv);
+  solver->createFlexTable();
+  solver->solve();
+  return {solver->getSOC(), solver->getMakespan(),
+          solver->succeed() && solver->getSolution().validate(&P)};
+}
+
+TEST(Concurrency, solvers)
+{
+  const int num_threads = 8;
+  const int num_runs = 32;
+
+  std::vector<Result> expected;
+  for (int k = 0; k < 4; ++k) expected.push_back(solve(k));
+  for (auto& r : expected) ASSERT_TRUE(r.valid);
+
+  std::vector<Result> results(num_runs);
+  std::vector<std::thread> threads;
+  for (int j = 0; j < num_threads; ++j) {
+    threads.emplace_back([&, j] {
+      for (int k = j; k < num_runs; k += num_threads) results[k] = solve(k);
+    });
+  }
+  for (auto& th : threads) th.join();
+
+  for (int k = 0; k < num_runs; ++k) ASSERT_EQ(results[k], expected[k % 4]);
+}
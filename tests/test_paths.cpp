@@ -98,3 +98,64 @@ TEST(Paths, conflict)
   paths4.insert(2, {w, w, w});
   ASSERT_EQ(paths4.countConflict(2, {w, w, u}), 1);
 }
+
+TEST(Paths, conflictIndex)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(2);
+  Node* x = G.getNode(3);
+
+  Paths paths(3);
+  paths.insert(0, {v, u, w});
+  paths.insert(1, {u, v, v});
+  paths.insert(2, {w, w, w});
+  auto conflicts = paths.getConflicts();
+  ASSERT_EQ(conflicts.size(), 2);
+  ASSERT_EQ(conflicts[0], std::make_tuple(0, 1, 1));  // swap
+  ASSERT_EQ(conflicts[1], std::make_tuple(0, 2, 2));  // vertex
+  ASSERT_EQ(paths.getConflicts({1, 2}).size(), 0);
+
+  // incremental update of the index
+  paths.insert(2, {w, x, x, x});
+  ASSERT_EQ(paths.countConflict(), 1);
+  paths.insert(0, {v, v});
+  ASSERT_EQ(paths.countConflict(), 1);
+  ASSERT_EQ(paths.countConflict({0, 2}), 0);
+}
+
+TEST(Paths, view)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(2);
+
+  Paths paths(2);
+  paths.insert(0, {v});
+  paths.insert(1, {u, w, w, u});
+  ASSERT_EQ(paths.getMakespan(), 3);
+
+  // stay at the last location
+  auto p = paths.get(0);
+  ASSERT_EQ(p.size(), 4);
+  ASSERT_EQ(p[3], v);
+  ASSERT_EQ(paths.last(0), v);
+  int cnt = 0;
+  for (auto x : p) {
+    ASSERT_EQ(x, v);
+    ++cnt;
+  }
+  ASSERT_EQ(cnt, 4);
+  Path q = paths.get(1);
+  ASSERT_EQ(q, Path({u, w, w, u}));
+
+  // cutoff
+  paths.insert(1, {u, w, w, w, w});
+  ASSERT_EQ(paths.getMakespan(), 4);
+  paths.insert(1, {u, w, w});
+  ASSERT_EQ(paths.getMakespan(), 1);
+  ASSERT_EQ(paths.get(1).size(), 2);
+  ASSERT_EQ(paths.costOfPath(1), 1);
+}
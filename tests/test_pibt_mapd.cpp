@@ -1,4 +1,5 @@
 #include <pibt_mapd.hpp>
+#include <queue>
 
 #include "gtest/gtest.h"
 
@@ -11,3 +12,144 @@ TEST(PIBT_MAPD, solve)
   ASSERT_TRUE(solver->succeed());
   ASSERT_TRUE(solver->getSolution().validate(&P));
 }
+
+// counts calls, without writing anything
+struct CountingStream : public PlanStream {
+  int configs = 0;
+  int target_events = 0;
+  int task_events = 0;
+
+  void begin(const std::string& map_file, const int width, const int height,
+             const Config& starts, const Config& goals,
+             const bool with_targets)
+  {
+  }
+  void config(const NodesView& c) { ++configs; }
+  void targetEvent(const TargetEvent& e) { ++target_events; }
+  void taskEvent(const TaskEvent& e) { ++task_events; }
+  void end(const std::string& info, const std::string& tasks) {}
+};
+
+TEST(PIBT_MAPD, history)
+{
+  for (auto record_history : {true, false}) {
+    auto P = MAPD_Instance("../tests/instances/test_mapd_pibt_ins.txt");
+    auto solver = std::make_unique<PIBT_MAPD>(&P);
+    CountingStream stream;
+    solver->setPlanStream(&stream);
+    solver->setRecordHistory(record_history);
+    solver->solve();
+    ASSERT_TRUE(solver->succeed());
+    ASSERT_EQ(stream.configs, solver->getSolution().size());
+
+    if (record_history) {
+      // only changes of targets, each task is assigned, picked, delivered
+      ASSERT_GT(stream.target_events, 0);
+      ASSERT_LT(stream.target_events, stream.configs * P.getNum());
+      ASSERT_GE(stream.task_events, 3 * P.getTaskNum());
+    } else {
+      ASSERT_EQ(stream.target_events, 0);
+      ASSERT_EQ(stream.task_events, 0);
+    }
+  }
+}
+
+TEST(PIBT_MAPD, pickup_field)
+{
+  Grid G("8x8.map");
+  PickupField field(&G);
+  Task a(0, G.getNode(0), G.getNode(63), 0);
+  Task b(1, G.getNode(7), G.getNode(56), 0);
+  Task c(2, G.getNode(7), G.getNode(63), 0);
+
+  ASSERT_EQ(field.getNearest(G.getNode(0)), nullptr);
+  ASSERT_EQ(field.getDist(G.getNode(0)), -1);
+
+  field.add(&a, 0.5);
+  field.add(&b, 0.5);
+  field.add(&c, 0.1);
+  ASSERT_EQ(field.getNearest(G.getNode(1)), &a);
+  ASSERT_EQ(field.getDist(G.getNode(1)), 1);
+  ASSERT_EQ(field.getNearest(G.getNode(7)), &c);  // same location, by key
+  ASSERT_EQ(field.getDist(G.getNode(7)), 0);
+  ASSERT_EQ(field.getNearest(G.getNode(63)), &c);
+  ASSERT_EQ(field.getDist(G.getNode(63)), 7);
+
+  field.remove(&c);
+  field.remove(&c);
+  ASSERT_FALSE(field.contains(&c));
+  ASSERT_EQ(field.getNearest(G.getNode(63)), &b);
+
+  field.remove(&a);
+  field.remove(&b);
+  ASSERT_TRUE(field.empty());
+  ASSERT_EQ(field.getNearest(G.getNode(1)), nullptr);
+}
+
+TEST(PIBT_MAPD, pickup_field_incremental)
+{
+  Grid G("random-32-32-20.map");
+  const int V = G.getNodesSize();
+  std::mt19937 MT(0);
+  PickupField field(&G);
+
+  // brute force, ordered by (distance, key, id)
+  auto bfs = [&](Node* s) {
+    std::vector<int> d(V, -1);
+    std::queue<Node*> OPEN;
+    d[s->id] = 0;
+    OPEN.push(s);
+    while (!OPEN.empty()) {
+      Node* v = OPEN.front();
+      OPEN.pop();
+      for (auto u : v->neighbor) {
+        if (d[u->id] != -1) continue;
+        d[u->id] = d[v->id] + 1;
+        OPEN.push(u);
+      }
+    }
+    return d;
+  };
+  std::vector<std::unique_ptr<Task>> tasks;
+  std::vector<std::vector<int>> fields;
+  std::vector<float> keys;
+  std::vector<bool> registered;
+
+  auto nodes = G.getV();
+  for (int step = 0; step < 300; ++step) {
+    const int n = tasks.size();
+    if (n > 0 && getRandomInt(0, 2, &MT) == 0) {
+      const int k = getRandomInt(0, n - 1, &MT);
+      field.remove(tasks[k].get());
+      registered[k] = false;
+    } else {
+      // few pickup locations and keys, to have many ties
+      Node* s = nodes[getRandomInt(0, 9, &MT) * 7 % nodes.size()];
+      tasks.push_back(std::make_unique<Task>(n, s, s, 0));
+      fields.push_back(bfs(s));
+      keys.push_back(getRandomInt(0, 1, &MT) * 0.5);
+      registered.push_back(true);
+      field.add(tasks[n].get(), keys[n]);
+    }
+
+    for (auto v : nodes) {
+      int best = -1;
+      for (int k = 0; k < (int)tasks.size(); ++k) {
+        const int d = fields[k][v->id];
+        if (!registered[k] || d == -1) continue;
+        if (best == -1 ||
+            std::make_tuple(d, keys[k], k) <
+                std::make_tuple(fields[best][v->id], keys[best], best)) {
+          best = k;
+        }
+      }
+      if (best == -1) {
+        ASSERT_EQ(field.getNearest(v), nullptr);
+        ASSERT_EQ(field.getDist(v), -1);
+      } else {
+        ASSERT_EQ(field.getNearest(v), tasks[best].get());
+        ASSERT_EQ(field.getDist(v), fields[best][v->id]);
+      }
+    }
+  }
+}
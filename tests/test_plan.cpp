@@ -114,6 +114,27 @@ TEST(Plan, validate)
   plan5.add({v});
   plan5.add({w});
   ASSERT_FALSE(plan5.validate({v}, {w}));
+
+  // swap conflict between non-adjacent agents
+  Node* x = G.getNode(3);
+  Plan plan6;
+  plan6.add({v, x, u});
+  plan6.add({u, x, v});
+  ASSERT_FALSE(plan6.validate({v, x, u}, {u, x, v}));
+
+  // vertex conflict of three agents
+  Plan plan7;
+  plan7.add({v, u, w});
+  plan7.add({u, u, u});
+  ASSERT_FALSE(plan7.validate({v, u, w}, {u, u, u}));
+
+  // rotation without conflicts
+  Node* y = G.getNode(8);
+  Node* z = G.getNode(9);
+  Plan plan8;
+  plan8.add({v, u, z, y});
+  plan8.add({u, z, y, v});
+  ASSERT_TRUE(plan8.validate({v, u, z, y}, {u, z, y, v}));
 }
 
 TEST(Plan, maxConstraintTime)
@@ -130,3 +151,50 @@ TEST(Plan, maxConstraintTime)
   ASSERT_EQ(plan.getMaxConstraintTime(0, v, u, &G), 1);
   ASSERT_EQ(plan.getMaxConstraintTime(1, u, w, &G), 0);
 }
+
+TEST(Plan, summary_only)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(2);
+
+  Plan plan;
+  plan.setSummaryOnly(true);
+  plan.add({v, u});
+  plan.add({v, w});
+  plan.add({u, w});
+  plan.add({u, w});
+  ASSERT_FALSE(plan.isComplete());
+  ASSERT_EQ(plan.size(), 4);
+  ASSERT_EQ(plan.getMakespan(), 3);
+  ASSERT_EQ(plan.getPathCost(0), 2);
+  ASSERT_EQ(plan.getPathCost(1), 1);
+  ASSERT_EQ(plan.getSOC(), 3);
+  ASSERT_EQ(plan.last()[0], u);
+  ASSERT_EQ(plan.last(1), w);
+  ASSERT_FALSE(plan.validate({v, u}));
+
+  // merge with a complete plan
+  Plan other;
+  other.add({u, w});
+  other.add({u, v});
+  plan += other;
+  ASSERT_EQ(plan.getMakespan(), 4);
+  ASSERT_EQ(plan.getPathCost(0), 2);
+  ASSERT_EQ(plan.getPathCost(1), 4);
+  ASSERT_EQ(plan.getSOC(), 6);
+
+  // merge with a summary, e.g., of a nested solver
+  Plan summary;
+  summary.setSummaryOnly(true);
+  summary.add({u, v});
+  summary.add({w, v});
+  summary.add({w, u});
+  plan += summary;
+  ASSERT_EQ(plan.getMakespan(), 6);
+  ASSERT_EQ(plan.getPathCost(0), 5);
+  ASSERT_EQ(plan.getPathCost(1), 6);
+  ASSERT_EQ(plan.last(1), u);
+  ASSERT_THROW(other += summary, std::runtime_error);
+}
@@ -0,0 +1,154 @@
+#include <fstream>
+#include <plan_stream.hpp>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+TEST(PlanStream, binary)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(9);
+  const std::string filename = "./test_plan_stream.bin";
+
+  {
+    BinaryPlanWriter writer(filename);
+    writer.begin("8x8.map", 8, 8, {v, u}, {w, v}, false);
+    writer.config(Config({v, u}));
+    writer.config(Config({v, w}));
+    writer.config(Config({u, w}));
+    writer.end("solved=1\n", "");
+  }
+
+  BinaryPlanReader reader(filename);
+  ASSERT_EQ(reader.getMapFile(), "8x8.map");
+  ASSERT_EQ(reader.getWidth(), 8);
+  ASSERT_EQ(reader.getNum(), 2);
+  ASSERT_FALSE(reader.isMAPD());
+  ASSERT_FALSE(reader.hasTargets());
+  ASSERT_EQ(reader.getGoals()[0], 9);
+  ASSERT_EQ(reader.getInfo(), "solved=1\n");
+
+  ASSERT_EQ(reader.next(), PlanFormat::CONFIG);
+  ASSERT_EQ(reader.getConfig(), std::vector<uint32_t>({0, 1}));
+  ASSERT_EQ(reader.next(), PlanFormat::CONFIG);
+  ASSERT_EQ(reader.getConfig(), std::vector<uint32_t>({0, 9}));
+  ASSERT_EQ(reader.next(), PlanFormat::CONFIG);
+  ASSERT_EQ(reader.getConfig(), std::vector<uint32_t>({1, 9}));
+  ASSERT_EQ(reader.next(), PlanFormat::END);
+  std::remove(filename.c_str());
+}
+
+TEST(PlanStream, events)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Task task(3, u, v, 0);
+  const std::string filename = "./test_plan_stream_task.bin";
+
+  {
+    BinaryPlanWriter writer(filename);
+    writer.begin("8x8.map", 8, 8, {v, v}, {}, true);
+    writer.config(Config({v, v}));
+    writer.targetEvent({0, 1, u, task.id});
+    writer.taskEvent({TaskEvent::ASSIGNED, task.id, 1, 0});
+    writer.config(Config({v, u}));
+    writer.taskEvent({TaskEvent::PICKED, task.id, 1, 1});
+    writer.targetEvent({1, 1, v, task.id});
+    writer.end("solved=1\n", "3:1->0,appear=0,finished=2\n");
+  }
+
+  BinaryPlanReader reader(filename);
+  ASSERT_TRUE(reader.isMAPD());
+  ASSERT_TRUE(reader.hasTargets());
+  ASSERT_EQ(reader.next(), PlanFormat::CONFIG);
+  ASSERT_EQ(reader.next(), PlanFormat::TARGET);
+  ASSERT_EQ(reader.getTargetEvent().timestep, 0);
+  ASSERT_EQ(reader.getTargetEvent().agent, 1);
+  ASSERT_EQ(reader.getTargets(), std::vector<uint32_t>({0, 1}));
+  ASSERT_EQ(reader.getTasks(), std::vector<int>({Task::NIL, 3}));
+  ASSERT_EQ(reader.next(), PlanFormat::TASK);
+  ASSERT_EQ(reader.getTaskEvent().type, TaskEvent::ASSIGNED);
+  ASSERT_EQ(reader.getTaskEvent().task_id, 3);
+  ASSERT_EQ(reader.getTaskEvent().agent, 1);
+  ASSERT_EQ(reader.next(), PlanFormat::CONFIG);
+  ASSERT_EQ(reader.next(), PlanFormat::TASK);
+  ASSERT_EQ(reader.getTaskEvent().type, TaskEvent::PICKED);
+  ASSERT_EQ(reader.getTaskEvent().timestep, 1);
+  ASSERT_EQ(reader.next(), PlanFormat::TARGET);
+  ASSERT_EQ(reader.getTargets(), std::vector<uint32_t>({0, 0}));
+  ASSERT_EQ(reader.next(), PlanFormat::END);
+  std::remove(filename.c_str());
+}
+
+TEST(PlanStream, write_error)
+{
+  std::FILE* fp = std::fopen("/dev/full", "wb");
+  if (fp == nullptr) GTEST_SKIP();
+  std::fclose(fp);
+
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  {
+    BinaryPlanWriter writer("/dev/full");
+    writer.begin("8x8.map", 8, 8, {v}, {v}, false);
+    writer.config(Config({v}));
+    ASSERT_THROW(writer.end("solved=1\n", ""), std::runtime_error);
+  }
+  {
+    // errors in destructor are reported without throwing
+    BinaryPlanWriter writer("/dev/full");
+    writer.begin("8x8.map", 8, 8, {v}, {v}, false);
+  }
+}
+
+TEST(PlanStream, read_error)
+{
+  const std::string filename = "./test_plan_stream_broken.bin";
+  ASSERT_THROW(BinaryPlanReader reader(filename), std::runtime_error);
+
+  // a short file, a trailer pointing beyond the end, and a valid footer
+  // without the header
+  const std::string footer("NOTAPLAN\0\0\0\x08\0\0\0\0\0\0\0", 19);
+  for (auto content : {std::string("PIBT2"), std::string(16, '\x7f'), footer}) {
+    std::ofstream(filename, std::ios::binary) << content;
+    ASSERT_THROW(BinaryPlanReader reader(filename), std::runtime_error);
+  }
+  std::remove(filename.c_str());
+}
+
+TEST(PlanStream, text)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(9);
+  const std::string filename = "./test_plan_stream.txt";
+
+  {
+    TextPlanWriter writer(filename);
+    writer.begin("8x8.map", 8, 8, {v, u}, {}, true);
+    writer.config(Config({v, u}));
+    writer.targetEvent({0, 0, w, Task::NIL});
+    writer.config(Config({w, u}));
+    writer.end("solved=1\n", "0:1->9,appear=0,finished=1\n");
+  }
+
+  std::ifstream file(filename);
+  std::stringstream buf;
+  buf << file.rdbuf();
+  ASSERT_EQ(buf.str(),
+            "map_file=8x8.map\n"
+            "agents=2\n"
+            "starts=(0,0),(1,0),\n"
+            "solution=\n"
+            "0:(0,0),(1,0),\n"
+            "0@0->(1,1):-1\n"
+            "1:(1,1),(1,0),\n"
+            "task=\n"
+            "0:1->9,appear=0,finished=1\n"
+            "solved=1\n");
+  std::remove(filename.c_str());
+}
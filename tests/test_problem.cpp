@@ -1,5 +1,6 @@
 #include <plan.hpp>
 #include <problem.hpp>
+#include <text_parser.hpp>
 
 #include "gtest/gtest.h"
 
@@ -63,3 +64,55 @@ TEST(MAPD_Instance, load)
     ASSERT_TRUE(int(P.getOpenTasks().size()) <= P.getTaskNum());
   }
 }
+
+TEST(MAPD_Instance, task_pool)
+{
+  auto P = MAPD_Instance("../tests/instances/toy_mapd.txt");
+  Task* first = P.getOpenTasks()[0];
+  ASSERT_EQ(first->id, 0);
+
+  for (int t = 0; t < P.getTaskNum(); ++t) {
+    // finish the oldest task
+    auto& open = P.getOpenTasks();
+    if (!open.empty()) open[0]->loc_current = open[0]->loc_delivery;
+    P.update();
+  }
+
+  // tasks never move, the id is a handle
+  ASSERT_EQ(P.getCreatedTaskNum(), P.getTaskNum());
+  ASSERT_EQ(P.getTask(0), first);
+  for (int id = 0; id < P.getCreatedTaskNum(); ++id) {
+    ASSERT_EQ(P.getTask(id)->id, id);
+  }
+
+  // closed in order of completion, open in order of appearance
+  auto& closed = P.getClosedTasks();
+  ASSERT_EQ(int(closed.size() + P.getOpenTasks().size()), P.getTaskNum());
+  for (int k = 0; k < (int)closed.size(); ++k) {
+    ASSERT_EQ(closed[k]->id, k);
+    ASSERT_EQ(closed[k]->timestep_finished, k + 1);
+  }
+}
+
+TEST(TextParser, scen)
+{
+  int x_s, y_s, x_g, y_g;
+  ASSERT_TRUE(TextParser::parseScenLine(
+      "0\trandom-32-32-20.map\t32\t32\t5\t7\t10\t2\t12.5", x_s, y_s, x_g, y_g));
+  ASSERT_EQ(x_s, 5);
+  ASSERT_EQ(y_s, 7);
+  ASSERT_EQ(x_g, 10);
+  ASSERT_EQ(y_g, 2);
+  ASSERT_FALSE(TextParser::parseScenLine("version 1", x_s, y_s, x_g, y_g));
+  ASSERT_FALSE(TextParser::parseScenLine("0\t.map\t32\t32\t5\t7\t10\t2\t1",
+                                         x_s, y_s, x_g, y_g));
+  ASSERT_FALSE(TextParser::parseScenLine("0\ta.map\t32\t32\t5\t7\t10\t2\t",
+                                         x_s, y_s, x_g, y_g));
+}
+
+TEST(Problem, cache)
+{
+  auto P1 = MAPD_Instance("../tests/instances/toy_mapd.txt");
+  auto P2 = MAPD_Instance("../tests/instances/test_mapd_pibt_ins.txt");
+  ASSERT_EQ(P1.getG(), P2.getG());
+}
@@ -26,3 +26,59 @@ TEST(planToPaths, convert)
   ASSERT_EQ(plan2.get(1, 0), u);
   ASSERT_EQ(plan2.get(1, 1), x);
 }
+
+TEST(Deadline, expire)
+{
+  Deadline deadline;
+  ASSERT_FALSE(deadline.expiredNow());
+  ASSERT_TRUE(deadline.within(0).expiredNow());
+
+  // cancellation is shared with nested deadlines
+  auto nested = deadline.within(60000);
+  ASSERT_FALSE(nested.expired());
+  deadline.cancel();
+  ASSERT_TRUE(nested.expired());
+  ASSERT_EQ(nested.getRemainedTime(), 0);
+}
+
+TEST(TargetDistanceTable, get)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(7);
+  Node* w = G.getNode(63);
+
+  TargetDistanceTable table(&G, {u, w, u}, 2);
+  ASSERT_EQ(table.getTargetsNum(), 2);
+  ASSERT_TRUE(table.isTarget(u));
+  ASSERT_FALSE(table.isTarget(v));
+  ASSERT_EQ(table.get(v, u), 7);
+  ASSERT_EQ(table.get(v, w), 14);
+  ASSERT_EQ(table.get(u, w), 7);
+  ASSERT_EQ(table.get(w, w), 0);
+  for (auto s : G.getV()) ASSERT_EQ(table.get(s, w), G.pathDist(s, w));
+}
+
+TEST(DistanceFieldCache, lru)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(7);
+  Node* w = G.getNode(63);
+
+  // two fields
+  DistanceFieldCache cache(&G, 2 * G.getNodesSize() * sizeof(int));
+  ASSERT_EQ(cache.getCapacity(), 2);
+  ASSERT_EQ(cache.get(v, u), 7);             // miss, field of u
+  ASSERT_EQ(cache.get(u, v), 7);             // hit, by symmetry
+  ASSERT_EQ(cache.get(v, w), 14);            // miss, field of w
+  ASSERT_EQ(cache.get(G.getNode(1), u), 6);  // hit, u is most recent
+  ASSERT_EQ(cache.get(G.getNode(1), v), 1);  // miss, evict w
+  ASSERT_EQ(cache.getSize(), 2);
+  ASSERT_EQ(cache.getHitCnt(), 2);
+  ASSERT_EQ(cache.getMissCnt(), 3);
+  ASSERT_EQ(cache.getEvictionCnt(), 1);
+  ASSERT_EQ(cache.get(w, u), 7);  // hit
+  ASSERT_EQ(cache.getEvictionCnt(), 1);
+  for (auto s : G.getV()) ASSERT_EQ(cache.get(s, w), G.pathDist(s, w));
+}
@@ -0,0 +1,23 @@
+#include <atomic>
+#include <sweep.hpp>
+#include <thread_pool.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(SweepConfig, parseList)
+{
+  ASSERT_EQ(SweepConfig::parseIntList("10:50:20,100"),
+            std::vector<int>({10, 30, 50, 100}));
+  ASSERT_EQ(SweepConfig::parseIntList("1:3"), std::vector<int>({1, 2, 3}));
+  ASSERT_EQ(SweepConfig::parseList("PIBT,HCA"),
+            std::vector<std::string>({"PIBT", "HCA"}));
+}
+
+TEST(ThreadPool, wait)
+{
+  ThreadPool pool(4);
+  std::atomic<int> cnt(0);
+  for (int k = 0; k < 100; ++k) pool.submit([&] { ++cnt; });
+  pool.wait();
+  ASSERT_EQ(cnt.load(), 100);
+}
@@ -2,6 +2,50 @@
 
 #include "gtest/gtest.h"
 
+// exposes internals of TP, planning with its own tokens
+class TPProbe : public TP
+{
+public:
+  using TP::TP;
+  using TP::deliveries;
+  using TP::last_reserved;
+  using TP::tail_agent;
+  using TP::token_tails;
+
+  std::vector<Path> TOKEN;
+
+  void initialize() { TP::initialize(TOKEN); }
+  void extendToken(int i, const Nodes& path)
+  {
+    TP::extendToken(i, path, TOKEN);
+  }
+  void updatePath(int i, const Nodes& waypoints)
+  {
+    TP::updatePath(i, waypoints, TOKEN);
+  }
+  Node* findEndpoint(int i) { return TP::findEndpoint(i, TOKEN); }
+  bool isOthersTail(int i, Node* v) const
+  {
+    return TP::isOthersTail(i, v, TOKEN);
+  }
+  int pathDist(Node* s, Node* g) const { return TP::pathDist(s, g); }
+};
+
+// random walk of agent i from its tail, not ending at tails of others
+static Nodes randomWalk(TPProbe& solver, int i, int len, std::mt19937* MT)
+{
+  Nodes path;
+  Node* v = solver.TOKEN[i].back();
+  for (int t = 0; t < len; ++t) {
+    Nodes C = v->neighbor;
+    C.push_back(v);
+    v = randomChoose(C, MT);
+    path.push_back(v);
+  }
+  if (!path.empty() && solver.isOthersTail(i, path.back())) return {};
+  return path;
+}
+
 TEST(TP, solve)
 {
   auto P = MAPD_Instance("../tests/instances/tp_mapd.txt");
@@ -11,3 +55,208 @@ TEST(TP, solve)
   ASSERT_TRUE(solver->succeed());
   ASSERT_TRUE(solver->getSolution().validate(&P));
 }
+
+TEST(TP, indexes)
+{
+  auto P = MAPD_Instance("../tests/instances/tp_warehouse.txt");
+  TPProbe solver(&P);
+  solver.initialize();
+  auto& TOKEN = solver.TOKEN;
+  const int NIL = ReservationTable::NIL;
+  std::mt19937 MT(0);
+
+  for (int step = 0; step < 100; ++step) {
+    const int i = getRandomInt(0, P.getNum() - 1, &MT);
+    solver.extendToken(i, randomWalk(solver, i, getRandomInt(0, 8, &MT), &MT));
+
+    // compare with scans over TOKEN
+    for (auto v : P.getG()->getV()) {
+      int tails = 0;
+      int agent = NIL;
+      int latest = NIL;
+      for (int j = 0; j < P.getNum(); ++j) {
+        if (TOKEN[j].back() == v) {
+          ++tails;
+          agent = j;
+        }
+        for (int t = 0; t < (int)TOKEN[j].size(); ++t) {
+          if (TOKEN[j][t] == v) latest = std::max(latest, t);
+        }
+      }
+      ASSERT_EQ(solver.token_tails[v->id], tails);
+      ASSERT_EQ(solver.tail_agent[v->id], agent);
+      ASSERT_EQ(solver.last_reserved[v->id], latest);
+      for (int j = 0; j < P.getNum(); ++j) {
+        const bool others_tail =
+            !std::all_of(TOKEN.begin(), TOKEN.end(), [&](const Path& path) {
+              return &path == &TOKEN[j] || path.back() != v;
+            });
+        ASSERT_EQ(solver.isOthersTail(j, v), others_tail);
+      }
+    }
+  }
+}
+
+TEST(TP, find_endpoint)
+{
+  auto P = MAPD_Instance("../tests/instances/tp_warehouse.txt");
+  TPProbe solver(&P);
+  solver.initialize();
+  auto& TOKEN = solver.TOKEN;
+  auto& endpoints = P.getEndpoints();
+  std::mt19937 MT(0);
+  Nodes deliveries;
+  int ties = 0;
+  int filtered = 0;
+
+  for (int step = 0; step < 30; ++step) {
+    // tokens stay longer than the current timestep
+    for (int i = 0; i < P.getNum(); ++i) {
+      Nodes path;
+      while (path.empty()) {
+        path = randomWalk(solver, i, getRandomInt(1, 8, &MT), &MT);
+      }
+      solver.extendToken(i, path);
+    }
+    P.update();
+    if (getRandomInt(0, 1, &MT) == 0) {
+      Node* v = randomChoose(endpoints, &MT);
+      deliveries.push_back(v);
+      ++solver.deliveries[v->id];
+    }
+
+    for (int i = 0; i < P.getNum(); ++i) {
+      // scan of endpoints, first one with the minimum distance
+      Node* loc = TOKEN[i][P.getCurrentTimestep()];
+      Node* target = nullptr;
+      int min_dist = 0;
+      int min_num = 0;
+      int nearest = -1;
+      for (auto p : endpoints) {
+        const int d = solver.pathDist(loc, p);
+        if (nearest == -1 || d < nearest) nearest = d;
+        if (std::find(deliveries.begin(), deliveries.end(), p) !=
+            deliveries.end()) {
+          continue;
+        }
+        bool others_tail = false;
+        for (int j = 0; j < P.getNum(); ++j) {
+          if (j != i && TOKEN[j].back() == p) others_tail = true;
+        }
+        if (others_tail) continue;
+        if (target == nullptr || d < min_dist) {
+          target = p;
+          min_dist = d;
+          min_num = 0;
+        }
+        if (d == min_dist) ++min_num;
+      }
+      ASSERT_EQ(solver.findEndpoint(i), target);
+      if (min_num > 1) ++ties;
+      if (target != nullptr && min_dist > nearest) ++filtered;
+    }
+  }
+  // both tie-breaking and the filters are exercised
+  ASSERT_GT(ties, 0);
+  ASSERT_GT(filtered, 0);
+}
+
+TEST(TP, waypoints)
+{
+  auto P = MAPD_Instance("../tests/instances/toy_mapd.txt");
+  auto G = P.getG();
+  std::mt19937 MT(0);
+
+  // pickup and delivery vs. two searches, with the same tokens of others
+  auto plan = [&](TPProbe& solver, const Nodes& walk, Node* p, Node* d,
+                  bool chained) {
+    solver.initialize();
+    solver.extendToken(1, walk);
+    if (chained) {
+      solver.updatePath(0, {p});
+      solver.updatePath(0, {d});
+    } else {
+      solver.updatePath(0, {p, d});
+    }
+    return solver.TOKEN[0];
+  };
+
+  // the delivery is on the way to the pickup, reached twice
+  {
+    Node* p = G->getNode(1, 5);
+    Node* d = G->getNode(1, 3);
+    TPProbe joint(&P), chained(&P);
+    const Path path = plan(joint, {}, p, d, false);
+    ASSERT_EQ(path.size(), 7);
+    ASSERT_EQ(path[2], d);
+    ASSERT_EQ(path[4], p);
+    ASSERT_EQ(path[6], d);
+    ASSERT_EQ(plan(chained, {}, p, d, true).size(), path.size());
+  }
+
+  for (int trial = 0; trial < 100; ++trial) {
+    TPProbe joint(&P), chained(&P);
+    joint.initialize();
+    const Nodes walk = randomWalk(joint, 1, getRandomInt(0, 8, &MT), &MT);
+    Node* tail = walk.empty() ? P.getStart(1) : walk.back();
+    Node* p = nullptr;
+    Node* d = nullptr;
+    while (p == nullptr || p == tail) p = randomChoose(G->getV(), &MT);
+    while (d == nullptr || d == tail || d == p) {
+      d = randomChoose(G->getV(), &MT);
+    }
+
+    const Path path = plan(joint, walk, p, d, false);
+    const Path other = joint.TOKEN[1];
+    const int cost = path.size();
+    const int cost_chained = plan(chained, walk, p, d, true).size();
+    // chained searches are a feasible plan for the joint one
+    ASSERT_LE(cost, cost_chained);
+    // the same cost when the other agent stays
+    if (walk.empty()) ASSERT_EQ(cost, cost_chained);
+
+    // pickup then delivery
+    ASSERT_EQ(path.back(), d);
+    const int t_p = std::find(path.begin() + 1, path.end(), p) - path.begin();
+    ASSERT_LT(t_p, cost - 1);
+
+    // no collision with the other agent, also after its token ends
+    for (int t = 0; t < cost; ++t) {
+      const int k = std::min(t, (int)other.size() - 1);
+      ASSERT_NE(path[t], other[k]);
+    }
+  }
+}
+
+TEST(ReservationTable, ring)
+{
+  const int NIL = ReservationTable::NIL;
+  ReservationTable table(4, 2);
+  table.set(0, 1, 0);
+  table.set(1, 2, 1);
+  ASSERT_EQ(table.get(0, 1), 0);
+  ASSERT_EQ(table.get(1, 2), 1);
+  ASSERT_EQ(table.get(2, 2), NIL);
+
+  // recycle the row of t=0
+  table.advance(1);
+  ASSERT_EQ(table.get(0, 1), NIL);
+  table.set(2, 3, 2);
+  ASSERT_EQ(table.getCapacity(), 2);
+  ASSERT_EQ(table.get(1, 2), 1);
+  ASSERT_EQ(table.get(2, 3), 2);
+  ASSERT_EQ(table.get(2, 1), NIL);
+
+  // grow beyond the ring, reservations remain
+  table.set(6, 0, 3);
+  ASSERT_EQ(table.getCapacity(), 8);
+  ASSERT_EQ(table.get(1, 2), 1);
+  ASSERT_EQ(table.get(2, 3), 2);
+  ASSERT_EQ(table.get(6, 0), 3);
+  ASSERT_EQ(table.get(5, 0), NIL);
+
+  // past timesteps cannot be reserved
+  table.advance(20);
+  ASSERT_EQ(table.get(6, 0), NIL);
+  ASSERT_THROW(table.set(19, 0, 0), std::runtime_error);
+}
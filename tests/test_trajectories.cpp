@@ -0,0 +1,52 @@
+#include <trajectories.hpp>
+
+#include "gtest/gtest.h"
+
+TEST(Trajectories, time_major)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(2);
+
+  Trajectories trajectories;
+  trajectories.addConfig({v, u});
+  trajectories.addConfig({u, w});
+  ASSERT_EQ(trajectories.getNumAgents(), 2);
+  ASSERT_EQ(trajectories.getHorizon(), 2);
+  ASSERT_EQ(trajectories.get(1, 0), u);
+  ASSERT_EQ(trajectories.getConfig(0)[1], u);
+
+  // agent-major layout is created on demand
+  auto p = trajectories.getPath(1);
+  ASSERT_EQ(p.size(), 2);
+  ASSERT_EQ(p[0], u);
+  ASSERT_EQ(p[1], w);
+}
+
+TEST(Trajectories, agent_major)
+{
+  Grid G("8x8.map");
+  Node* v = G.getNode(0);
+  Node* u = G.getNode(1);
+  Node* w = G.getNode(2);
+
+  Trajectories trajectories(Trajectories::AGENT_MAJOR, 2);
+  trajectories.setPath(0, {v});
+  trajectories.setPath(1, {u, w, w});
+  ASSERT_EQ(trajectories.getPathLength(0), 1);
+  ASSERT_EQ(trajectories.getHorizon(), 3);
+  ASSERT_EQ(trajectories.get(2, 0), v);
+
+  // padded configurations
+  trajectories.setLayout(Trajectories::TIME_MAJOR);
+  ASSERT_EQ(trajectories.getHorizon(), 3);
+  ASSERT_EQ(trajectories.getConfig(2)[0], v);
+  ASSERT_EQ(trajectories.getConfig(2)[1], w);
+
+  // back to paths
+  trajectories.setLayout(Trajectories::AGENT_MAJOR);
+  trajectories.resizePath(1, 2);
+  ASSERT_EQ(trajectories.getPath(1).size(), 2);
+  ASSERT_EQ(trajectories.getPath(0).size(), 3);
+}
@@ -6,7 +6,7 @@ using Configs = std::vector<Config>;
 
 struct MAPFPlan {
   int num_agents;         // number of agents
-  Grid* G;                // grid
+  Grid* G = nullptr;      // grid
   std::string solver;     // solver name
   bool solved;            // success or not
   int soc;                // sum of cost
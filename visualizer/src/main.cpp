@@ -101,14 +101,54 @@ void readSetResult(const std::string& result_file, MAPFPlan* plan)
   std::regex r_goals     = std::regex(R"(goals=(.+))");
   std::regex r_sol       = std::regex(R"(solution=)");
   std::regex r_config    = std::regex(R"(\d+:(.+))");
+  // streamed MAPD logs, change of target: timestep@agent->(x,y):task
+  std::regex r_target    = std::regex(R"((\d+)@(\d+)->\((\d+),(\d+)\):(-1|\d+))");
   std::regex r_service_time = std::regex(R"(service_time=(.+))");
 
+  struct TargetEvent {
+    int t;
+    int i;
+    Node* v;
+    bool assigned;
+  };
+  std::vector<TargetEvent> target_events;
+
   std::string line;
   std::smatch results;
+  bool in_solution = false;
   while (getline(file, line)) {
-    // read map
+    // solution, streamed logs have result info after this block
+    if (in_solution) {
+      if (std::regex_match(line, results, r_target)) {
+        const int x = std::stoi(results[3].str());
+        const int y = std::stoi(results[4].str());
+        if (!plan->G->existNode(x, y)) {
+          std::cout << "error@main, node does not exist" << std::endl;
+          delete plan->G;
+          std::exit(1);
+        }
+        target_events.push_back({std::stoi(results[1].str()),
+                                 std::stoi(results[2].str()),
+                                 plan->G->getNode(x, y),
+                                 results[5].str() != "-1"});
+        continue;
+      }
+      if (std::regex_match(line, results, r_config)) {
+        Config c, targets;
+        std::vector<bool> assigned;
+        readSetNode(results[1].str(), c, plan->G, targets, assigned);
+        plan->transitions.push_back(c);
+        if (!targets.empty()) plan->targets.push_back(targets);
+        if (!assigned.empty()) plan->assigned.push_back(assigned);
+        continue;
+      }
+      in_solution = false;
+    }
+    // read map, streamed logs repeat it in result info
     if (std::regex_match(line, results, r_map)) {
-      plan->G = new Grid(results[1].str());  // deleted in destructor of MAPFPlan
+      if (plan->G == nullptr) {
+        plan->G = new Grid(results[1].str());  // deleted in destructor of MAPFPlan
+      }
       continue;
     }
     // set agent num
@@ -158,16 +198,22 @@ void readSetResult(const std::string& result_file, MAPFPlan* plan)
     }
     // solution
     if (std::regex_match(line, results, r_sol)) {
-      while (getline(file, line)) {
-        if (std::regex_match(line, results, r_config)) {
-          Config c, targets;
-          std::vector<bool> assigned;
-          readSetNode(results[1].str(), c, plan->G, targets, assigned);
-          plan->transitions.push_back(c);
-          if (!targets.empty()) plan->targets.push_back(targets);
-          if (!assigned.empty()) plan->assigned.push_back(assigned);
-        }
-      }
+      in_solution = true;
+      continue;
+    }
+  }
+
+  // targets of each timestep from changes, initially starts and free
+  if (target_events.empty()) return;
+  Config targets = plan->config_s;
+  std::vector<bool> assigned(targets.size(), false);
+  auto itr = target_events.begin();
+  for (int t = 0; t < (int)plan->transitions.size(); ++t) {
+    for (; itr != target_events.end() && itr->t == t; ++itr) {
+      targets[itr->i] = itr->v;
+      assigned[itr->i] = itr->assigned;
     }
+    plan->targets.push_back(targets);
+    plan->assigned.push_back(assigned);
   }
 }